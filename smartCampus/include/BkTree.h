@@ -0,0 +1,45 @@
+#ifndef BK_TREE_H
+#define BK_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 名称模糊匹配用的 BK 树，距离为按 UTF-8 码点计算的编辑距离（ASCII 不区分大小写）。
+// 同名地点共用一个节点。BK 树不便删除节点，名称被删除后节点只变成空壳继续参与路由，
+// 空壳数量超过有效节点时整体重建。
+class BkTree {
+private:
+    struct Node {
+        std::u32string key;
+        std::vector<int> ids;
+        std::vector<std::pair<int, std::uint32_t>> children; // (与本节点的距离, 子节点)
+    };
+
+    std::vector<Node> nodes; // nodes[0] 为根（树非空时）
+    std::unordered_map<std::string, std::uint32_t> nodeByName;
+    std::unordered_map<int, std::string> nameById;
+    std::size_t emptyNodes = 0;
+
+    static std::u32string toKey(const std::string& lowerName);
+    void insertName(const std::string& lowerName, int id);
+    void rebuild();
+
+public:
+    // 码点级编辑距离；超过 limit 时提前结束并返回 limit + 1
+    static int distance(const std::u32string& a, const std::u32string& b, int limit);
+
+    void clear();
+    void add(int id, std::string_view name);
+    void remove(int id);
+    std::size_t size() const;
+
+    // 与 keyword 的编辑距离不超过 maxDistance 的全部地点，返回 (距离, ID)，不保证顺序
+    std::vector<std::pair<int, int>> search(std::string_view keyword, int maxDistance) const;
+};
+
+#endif // BK_TREE_H
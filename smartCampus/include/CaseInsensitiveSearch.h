@@ -0,0 +1,10 @@
+#ifndef CASE_INSENSITIVE_SEARCH_H
+#define CASE_INSENSITIVE_SEARCH_H
+
+#include <string_view>
+
+// 判断 text 中是否包含 keyword，ASCII 字母不区分大小写，多字节字符按字节精确比较。
+// 原地比较，不分配内存；x86 上按 CPU 支持情况选用 AVX2 或 SSE2，其余平台使用标量实现。
+bool containsIgnoreCase(std::string_view text, std::string_view keyword);
+
+#endif // CASE_INSENSITIVE_SEARCH_H
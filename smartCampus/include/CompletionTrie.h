@@ -0,0 +1,64 @@
+#ifndef COMPLETION_TRIE_H
+#define COMPLETION_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 名称前缀补全：按 UTF-8 码点建立的字典树，每个节点缓存子树内人气最高的若干地点。
+// 新增地点或人气上升时沿路径就地更新缓存；缓存中的地点被删除或人气下降时只把路径标记为脏，
+// 下一次查询到该节点时再由子节点的缓存合并重算，因此每次按键只需走一遍前缀。
+class CompletionTrie {
+public:
+    static constexpr std::size_t kCachedCount = 16;
+
+private:
+    struct Entry {
+        int popularity;
+        int id;
+    };
+
+    struct Node {
+        std::vector<std::pair<char32_t, std::uint32_t>> children; // 按码点升序
+        std::vector<int> terminals;                               // 名称恰好到此结束的地点
+        std::vector<Entry> top;                                   // 子树内人气前 kCachedCount 名
+        bool dirty = false;
+    };
+
+    struct Item {
+        std::string lowerName;
+        int popularity;
+    };
+
+    std::vector<Node> nodes; // nodes[0] 为根
+    std::unordered_map<int, Item> items;
+
+    static bool ranksBefore(const Entry& a, const Entry& b);
+    std::uint32_t child(std::uint32_t node, char32_t cp) const;
+    std::uint32_t childOrCreate(std::uint32_t node, char32_t cp);
+    std::vector<std::uint32_t> pathOf(const std::string& lowerName, bool create);
+    void refresh(std::uint32_t node);
+    void collect(std::uint32_t node, std::vector<Entry>& out);
+    void insertItem(int id, const Item& item);
+    void eraseItem(int id, const Item& item);
+
+public:
+    CompletionTrie();
+
+    void clear();
+    // 新增或更新地点（名称或人气变化均可）
+    void upsert(int id, std::string_view name, int popularity);
+    void remove(int id);
+    std::size_t size() const;
+
+    // 名称以 prefix 开头（ASCII 不区分大小写）的地点，按人气降序、ID 升序取前 k 个
+    std::vector<int> complete(std::string_view prefix, std::size_t k);
+    // 名称与 name 完全相同（ASCII 不区分大小写）的地点
+    std::vector<int> exactMatches(std::string_view name) const;
+};
+
+#endif // COMPLETION_TRIE_H
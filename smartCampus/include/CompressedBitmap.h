@@ -0,0 +1,72 @@
+#ifndef COMPRESSED_BITMAP_H
+#define COMPRESSED_BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 压缩位图（Roaring 思路）：按高 16 位分块，每块元素不多时存有序 uint16 数组，
+// 超过 4096 个改存 65536 位的位集，稀疏和稠密的集合都占用较少内存，
+// 求交集时也只需处理两边都存在的块。
+class CompressedBitmap {
+private:
+    struct Container {
+        std::uint16_t key = 0;
+        std::vector<std::uint16_t> array; // 有序数组形式
+        std::vector<std::uint64_t> bits;  // 位集形式，非空时 array 不使用
+        std::uint32_t count = 0;
+
+        bool isBitset() const { return !bits.empty(); }
+    };
+
+    static constexpr std::uint32_t kArrayLimit = 4096;
+    // 逐个删除时要降到这个数以下才改回数组，避免在 4096 附近反复增删时来回转换
+    static constexpr std::uint32_t kBitsetLowWater = kArrayLimit * 3 / 4;
+    static constexpr std::size_t kBitsetWords = 65536 / 64;
+
+    std::vector<Container> containers; // 按 key 升序
+
+    std::vector<Container>::iterator findContainer(std::uint16_t key);
+    std::vector<Container>::const_iterator findContainer(std::uint16_t key) const;
+    static void toBitset(Container& c);
+    static void toArray(Container& c);
+    static Container intersect(const Container& a, const Container& b);
+    static Container unite(const Container& a, const Container& b);
+
+public:
+    static CompressedBitmap fromSorted(const std::vector<std::uint32_t>& values);
+
+    void add(std::uint32_t value);
+    void remove(std::uint32_t value);
+    bool contains(std::uint32_t value) const;
+    std::size_t cardinality() const;
+    bool empty() const;
+    void clear();
+
+    CompressedBitmap& operator&=(const CompressedBitmap& other);
+    CompressedBitmap& operator|=(const CompressedBitmap& other);
+
+    // 按升序访问每个元素
+    template <typename Visitor>
+    void forEach(Visitor&& visitor) const {
+        for (const auto& c : containers) {
+            std::uint32_t high = static_cast<std::uint32_t>(c.key) << 16;
+            if (c.isBitset()) {
+                for (std::size_t w = 0; w < kBitsetWords; ++w) {
+                    std::uint64_t word = c.bits[w];
+                    while (word != 0) {
+                        unsigned bit = static_cast<unsigned>(__builtin_ctzll(word));
+                        visitor(high | static_cast<std::uint32_t>(w * 64 + bit));
+                        word &= word - 1;
+                    }
+                }
+            } else {
+                for (std::uint16_t low : c.array) {
+                    visitor(high | low);
+                }
+            }
+        }
+    }
+};
+
+#endif // COMPRESSED_BITMAP_H
@@ -0,0 +1,49 @@
+#ifndef FILTER_INDEX_H
+#define FILTER_INDEX_H
+
+#include "CompressedBitmap.h"
+#include "TypeDictionary.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 组合筛选用的位图索引：每个地点占一个紧凑的槽位号，
+// 按类型编号、按人气区间（0 以下一档，其余按 2 的幂分档）各维护一张压缩位图。
+// 类型编号来自快照的类型字典，同一份数据内只增不变；整体重载会截断变更日志，索引随之全量重建。
+// 查询时先对各条件的位图求交集，只有落在边界档位上的槽位才需要再核对具体人气。
+class FilterIndex {
+private:
+    static constexpr int kBucketCount = 32;
+
+    std::unordered_map<int, std::uint32_t> slotById;
+    std::vector<int> idBySlot;
+    std::vector<int> popularityBySlot;
+    std::vector<TypeId> typeBySlot;
+    std::vector<std::uint32_t> freeSlots;
+    std::unordered_map<TypeId, CompressedBitmap> typeBitmaps;
+    std::vector<CompressedBitmap> bucketBitmaps;
+    CompressedBitmap liveSlots;
+
+    static int bucketOf(int popularity);
+    static long long bucketLow(int bucket);
+    static long long bucketHigh(int bucket);
+
+public:
+    FilterIndex();
+
+    void clear();
+    // 新增或更新地点的类型与人气
+    void add(int id, TypeId type, int popularity);
+    void remove(int id);
+    std::size_t size() const;
+
+    // 满足全部条件的地点 ID（顺序不定）。type 为空指针表示不限类型；
+    // candidates 不为空时只在其中的地点里筛选（通常是名称匹配结果）
+    std::vector<int> filter(const TypeId* type, int minPopularity, int maxPopularity,
+                            const std::vector<int>* candidates) const;
+};
+
+#endif // FILTER_INDEX_H
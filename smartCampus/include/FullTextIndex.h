@@ -0,0 +1,65 @@
+#ifndef FULL_TEXT_INDEX_H
+#define FULL_TEXT_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 名称、类型、描述的全文倒排索引，BM25 打分后乘以人气加成。
+// 分词见 tokenizeText；名称、类型的词频按字段权重放大。
+// 查询按 MaxScore 思路逐文档推进：每个词项有一个得分上界，
+// 当前第 k 名的分数超过若干词项上界之和后，这些词项只用于补分，不再产生候选文档。
+class FullTextIndex {
+public:
+    struct Hit {
+        int id;
+        double score;
+    };
+
+private:
+    struct Posting {
+        int id;
+        float weight; // 字段加权后的词频
+    };
+
+    struct Term {
+        std::string text;              // 词项原文，倒排表清空时据此从 termIds 中删除
+        std::vector<Posting> postings; // 按地点 ID 升序
+        // 用于估计得分上界；删除文档时不回退，上界只会偏大，不影响正确性
+        float maxWeight = 0.0f;
+        float minLength = 0.0f;
+    };
+
+    struct Document {
+        std::vector<std::pair<std::uint32_t, float>> terms;
+        float length = 0.0f;
+        int popularity = 0;
+    };
+
+    std::unordered_map<std::string, std::uint32_t> termIds;
+    std::vector<Term> terms;
+    std::vector<std::uint32_t> freeTermIds; // 已删除词项空出的编号，新词项优先复用
+    std::unordered_map<int, Document> documents;
+    double totalLength = 0.0;
+    int maxPopularity = 0; // 同样只增不减，作为人气加成的上界
+
+    static double popularityBoost(int popularity);
+    std::uint32_t termId(const std::string& token);
+
+public:
+    void clear();
+    // 新增或替换一个地点，总是重新分词；只有人气变化时请用 setPopularity
+    void add(int id, std::string_view name, std::string_view type, std::string_view description, int popularity);
+    void remove(int id);
+    // 只更新人气，不重新分词；地点尚未收录时返回 false
+    bool setPopularity(int id, int popularity);
+    std::size_t size() const;
+
+    // 得分最高的 k 个地点，按分数降序、ID 升序
+    std::vector<Hit> search(std::string_view query, std::size_t k) const;
+};
+
+#endif // FULL_TEXT_INDEX_H
@@ -0,0 +1,29 @@
+#ifndef LOCATION_H
+#define LOCATION_H
+
+#include "TypeDictionary.h"
+
+#include <string>
+#include <string_view>
+
+struct Location {
+    int id;
+    std::string name;
+    std::string type;
+    std::string description;
+    int popularity; // 新增：人气值（访问量/评分等）
+};
+
+// 地点的只读视图：不拷贝字符串，生命周期受产生它的 LocationSnapshot 约束
+struct LocationView {
+    int id;
+    std::string_view name;
+    std::string_view type;
+    std::string_view description;
+    int popularity;
+    TypeId typeId; // 所属 LocationManager 类型字典中的编号
+
+    Location toLocation() const;
+};
+
+#endif // LOCATION_H
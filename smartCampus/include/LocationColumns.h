@@ -0,0 +1,32 @@
+#ifndef LOCATION_COLUMNS_H
+#define LOCATION_COLUMNS_H
+
+#include "TypeDictionary.h"
+
+#include <cstddef>
+#include <vector>
+
+// 列式（SoA）热字段：id、人气、类型编号各自连续存放，
+// 只扫描人气/类型的操作（排行、筛选）不再把名称、描述带进缓存。
+// 名称和描述只保存在快照的行记录中，这里不重复存放；修改按行就地进行。
+class LocationColumns {
+private:
+    std::vector<int> ids;
+    std::vector<int> popularity;
+    std::vector<TypeId> typeIds;
+
+public:
+    void clear();
+    void reserve(std::size_t rows);
+    void append(int id, int popularityValue, TypeId typeId);
+    void setPopularity(std::size_t row, int value);
+    void setType(std::size_t row, TypeId typeId);
+    void erase(std::size_t row);
+
+    std::size_t size() const;
+    const std::vector<int>& idColumn() const;
+    const std::vector<int>& popularityColumn() const;
+    const std::vector<TypeId>& typeColumn() const;
+};
+
+#endif // LOCATION_COLUMNS_H
@@ -1,34 +1,143 @@
 #ifndef LOCATION_MANAGER_H
 #define LOCATION_MANAGER_H
 
+#include "Location.h"
+#include "LocationSnapshot.h"
+#include "LruCache.h"
+#include "PopularityCounter.h"
+#include "TypeDictionary.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
-struct Location {
-    int id;
-    std::string name;
-    std::string type;
-    std::string description;
-    int popularity; // 新增：人气值（访问量/评分等）
-};
+class LocationColumns;
 
+// 地点数据管理。读操作基于当前快照（RCU 风格）：读者原子地取得快照的
+// shared_ptr 后无需加锁；写者在 writeMutex 下复制当前快照、修改副本，
+// 再原子地发布新版本，因此搜索/排行不会被编辑阻塞。
 class LocationManager {
 private:
-    std::vector<Location> locations;
+    std::shared_ptr<const LocationSnapshot> current; // 只能通过 std::atomic_load/atomic_store 访问
     std::string filename;
+    bool columnarEnabled = false;
+
+    std::mutex writeMutex;                        // 串行化所有修改操作
+    PopularityCounter visitCounter;               // 尚未写回的访问增量
+    std::atomic<long long> visitFlushThreshold{ 1024 }; // 累计增量达到该值时自动发布，0 表示只手动写回
+    bool popularityUnsaved = false;               // 已发布但尚未写入数据文件的人气，受 writeMutex 保护
+
+    // 描述延迟加载：描述只在数据文件中保留一份，按需读取并放入小型 LRU 缓存。
+    // fileMutex 保证读取描述时数据文件内容与当前快照记录的偏移量一致。
+    // 开关只在 writeMutex 下修改，但读者不加锁读取，因此用原子变量
+    std::atomic<bool> lazyDescriptions{ false };
+    mutable std::shared_mutex fileMutex;
+    mutable std::mutex cacheMutex;
+    mutable LruCache<int, std::string> descriptionCache{ 64 };
+
+    // 变更日志：记录每个版本改动过的地点 ID，供排行、搜索等派生索引增量同步。
+    // 超出容量或整体重载时截断，早于 journalStart 的变更不再可查。
+    static constexpr std::size_t kJournalCapacity = 4096;
+    mutable std::mutex journalMutex;
+    struct JournalEntry {
+        std::uint64_t generation;
+        int id;
+        bool popularityOnly; // 只改了人气（访问计数写回）
+        std::chrono::steady_clock::time_point publishedAt;
+    };
+    std::deque<JournalEntry> journal;
+    std::uint64_t journalStart = 0;
+
+    std::shared_ptr<LocationSnapshot> beginWrite() const;
+    // reload 表示整体重载：截断变更日志，之前的代数都需要全量重建
+    void publish(std::shared_ptr<LocationSnapshot> next, const std::vector<int>& changedIds = {},
+                 bool popularityOnly = false, bool reload = false);
+    void commit(std::shared_ptr<LocationSnapshot> next, const std::vector<int>& changedIds = {},
+                bool popularityOnly = false);
+    void persist();
+    bool writeFile();
+    bool writeDetached(const LocationSnapshot& next, const std::string& path,
+                       std::vector<std::pair<std::uint64_t, std::uint32_t>>& offsets) const;
+    std::string readDescription(const LocationSnapshot& snap, std::size_t row, std::ifstream& fin) const;
+    std::size_t applyVisits();
 
 public:
     LocationManager(const std::string& file);
+    ~LocationManager();
 
     void loadFromFile();
-    void saveToFile();
+    void saveToFile(); // 连同尚未写回的访问计数一起保存
 
     void addLocation(const Location& loc);
     void removeLocation(int id);
     void updateLocation(int id, const Location& newInfo);
-    Location* findLocation(int id);
+    // 按 ID 取得地点的副本（延迟加载模式下包含描述）；未找到时返回 false。
+    // 快照不可变且随时会被新版本替换，因此不再返回指向内部记录的指针，修改请用 updateLocation
+    bool findLocation(int id, Location& out) const;
     std::vector<Location> getAllLocations() const;
     void listAll();
+
+    // 当前版本的不可变快照；需要跨多次调用保持一致或在其他线程中读取时使用
+    std::shared_ptr<const LocationSnapshot> snapshot() const;
+    // 变更代数：每次修改数据后单调递增，派生缓存比较代数即可判断是否失效
+    std::uint64_t generation() const;
+    // 取得代数 since 之后改动过的地点 ID（可能重复，含增删改）。
+    // 日志已截断时返回 false，调用方应按当前快照全量重建。
+    bool changesSince(std::uint64_t since, std::vector<int>& ids) const;
+    // 同上，但把只改了人气的地点单独列出：contentIds 中的地点可能被增删或改了名称、类型、描述，
+    // popularityIds 中的地点在这段时间内只有人气变化。两者各自去重且互不重叠
+    bool changesSince(std::uint64_t since, std::vector<int>& contentIds, std::vector<int>& popularityIds) const;
+    // 同第一种，但带上每条变更所在版本的发布时刻（按发布先后排列），供需要按时间计算的索引使用
+    struct Change {
+        int id;
+        std::chrono::steady_clock::time_point publishedAt;
+    };
+    bool changesSince(std::uint64_t since, std::vector<Change>& changes) const;
+
+    // 只读访问：按存储顺序遍历，不复制地点数据。
+    // 以下便捷接口返回的视图/引用只在下一次修改前有效，并发读取请改用 snapshot()
+    std::size_t size() const;
+    void forEachLocation(const std::function<void(const LocationView&)>& visitor) const;
+    bool viewLocation(int id, LocationView& out) const;
+
+    // 类型字典：类型比较只需比较整数编号。
+    // 返回的指针与所属快照共享所有权，持有期间字典一直有效，不受之后的修改影响
+    std::shared_ptr<const TypeDictionary> typeDictionary() const;
+    std::vector<std::string> listTypes() const;
+    std::size_t countByType(const std::string& type) const;
+    void forEachOfType(const std::string& type, const std::function<void(const LocationView&)>& visitor) const;
+
+    // 列式布局：启用后额外维护 id/人气/类型三列 SoA 数据（不含名称、描述），供只关心人气/类型的扫描使用
+    void setColumnarLayout(bool enabled);
+    bool columnarLayout() const;
+    // 当前快照的列数据，未启用列式布局时为空；与 typeDictionary() 一样共享快照的所有权
+    std::shared_ptr<const LocationColumns> columns() const;
+
+    // 访问计数热路径：可在多个线程中调用，只累加内存计数，达到阈值后分批发布新的人气值；
+    // 数据文件只在 flushVisits()/saveToFile() 或析构时写回
+    void recordVisit(int id);
+    std::size_t flushVisits();
+    long long pendingVisits() const;
+    void setVisitFlushThreshold(long long threshold);
+
+    // 描述延迟加载：启用后视图中的 description 为空，详情请通过 description() 获取
+    void setLazyDescriptions(bool enabled);
+    bool lazyDescriptionsEnabled() const;
+    void setDescriptionCacheCapacity(std::size_t capacity);
+    std::string description(int id) const;
+    // 批量读取描述：只打开一次数据文件并按文件偏移顺序读取，适合导出整张排行等大量行的场景。
+    // 结果与 ids 一一对应，不存在的 ID 对应空串；不经过描述缓存
+    std::vector<std::string> descriptions(const std::vector<int>& ids) const;
 };
 
 #endif // LOCATION_MANAGER_H
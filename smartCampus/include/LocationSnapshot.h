@@ -0,0 +1,93 @@
+#ifndef LOCATION_SNAPSHOT_H
+#define LOCATION_SNAPSHOT_H
+
+#include "Location.h"
+#include "LocationColumns.h"
+#include "TypeDictionary.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class LocationManager;
+
+// 某一时刻全部地点数据的不可变版本。
+// LocationManager 发布后不再修改；读者持有 shared_ptr 即可在不加锁的情况下
+// 安全遍历，视图在该快照存活期间一直有效。
+class LocationSnapshot {
+private:
+    friend class LocationManager;
+
+    // 内部行记录：类型只保存字典编号，不再每行重复存放类型字符串。
+    // 人气变化频繁，不放在行记录里，见下方 popularity
+    struct Record {
+        int id;
+        std::string name;
+        TypeId typeId;
+        std::string description;
+        // 延迟加载模式下描述留在数据文件中，只记录其字节偏移和长度
+        std::uint64_t descriptionOffset = 0;
+        std::uint32_t descriptionLength = 0;
+        bool descriptionOnDisk = false;
+    };
+
+    // 冷数据：只有增删改地点、改写描述位置时才变化，相邻版本共享同一份
+    struct Table {
+        std::vector<Record> records;
+        std::unordered_map<int, std::size_t> rowById;
+        TypeDictionary types;
+        std::vector<std::size_t> typeCounts; // 按类型编号统计的地点数量
+    };
+
+    std::shared_ptr<Table> table;
+    bool ownsTable = true;                        // 写者首次修改冷数据时才复制一份 table
+    std::vector<int> popularity;                  // 按行存放的人气，每个版本各自一份
+    std::unique_ptr<LocationColumns> columnStore; // 可选的热字段列，未启用时为空
+    std::uint64_t generationNumber = 0;           // 发布序号，每发布一个新版本加一
+    std::chrono::steady_clock::time_point publishTime;
+
+    // 以下修改接口只在快照发布前由 LocationManager 调用
+    Table& editTable();
+    const Record& recordAt(std::size_t row) const;
+    Record makeRecord(Table& data, const Location& loc);
+    bool append(const Location& loc);
+    bool remove(int id);
+    bool update(int id, const Location& newInfo);
+    void setPopularity(std::size_t row, int value);
+    void detachDescription(std::size_t row, std::uint64_t offset, std::uint32_t length);
+    void attachDescription(std::size_t row, std::string text);
+    void setColumnar(bool enabled);
+
+public:
+    LocationSnapshot();
+    // 副本与原版本共享冷数据，只复制人气等热数据
+    LocationSnapshot(const LocationSnapshot& other);
+    LocationSnapshot& operator=(const LocationSnapshot&) = delete;
+
+    std::uint64_t generation() const;
+    // 本版本的发布时刻
+    std::chrono::steady_clock::time_point publishedAt() const;
+    std::size_t size() const;
+    LocationView viewAt(std::size_t row) const;
+    // 按行读取单个热字段，扫描时不触碰名称、描述
+    int idAt(std::size_t row) const;
+    int popularityAt(std::size_t row) const;
+    TypeId typeAt(std::size_t row) const;
+    bool viewLocation(int id, LocationView& out) const;
+    bool rowOf(int id, std::size_t& row) const;
+    void forEachLocation(const std::function<void(const LocationView&)>& visitor) const;
+
+    const TypeDictionary& typeDictionary() const;
+    std::vector<std::string> listTypes() const;
+    std::size_t countByType(const std::string& type) const;
+    void forEachOfType(const std::string& type, const std::function<void(const LocationView&)>& visitor) const;
+
+    const LocationColumns* columns() const;
+};
+
+#endif // LOCATION_SNAPSHOT_H
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+// 固定容量的 LRU 缓存：命中时把条目移到最前，超出容量时淘汰最久未使用的条目。
+// 本身不加锁，多线程使用时由调用方负责同步。
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity) : capacity_(capacity) {}
+
+    bool get(const Key& key, Value& out) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        items_.splice(items_.begin(), items_, it->second);
+        out = it->second->second;
+        return true;
+    }
+
+    void put(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->second = std::move(value);
+            items_.splice(items_.begin(), items_, it->second);
+            return;
+        }
+        items_.emplace_front(key, std::move(value));
+        index_.emplace(key, items_.begin());
+        evict();
+    }
+
+    void erase(const Key& key) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            items_.erase(it->second);
+            index_.erase(it);
+        }
+    }
+
+    void clear() {
+        items_.clear();
+        index_.clear();
+    }
+
+    std::size_t size() const {
+        return items_.size();
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+    void setCapacity(std::size_t capacity) {
+        capacity_ = capacity;
+        evict();
+    }
+
+private:
+    void evict() {
+        while (items_.size() > capacity_) {
+            index_.erase(items_.back().first);
+            items_.pop_back();
+        }
+    }
+
+    std::list<std::pair<Key, Value>> items_;
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value>>::iterator, Hash> index_;
+    std::size_t capacity_;
+};
@@ -1,6 +1,7 @@
 #ifndef NAVIGATION_GRAPH_H
 #define NAVIGATION_GRAPH_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -9,6 +10,7 @@
 class NavigationGraph {
 private:
     std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> adjacency;
+    std::uint64_t generationCounter = 0; // 每次修改后加一，供路径缓存校验
 
 public:
     void addLocation(const std::string& name);
@@ -19,6 +21,7 @@ public:
     std::vector<std::string> shortestPath(const std::string& start, const std::string& end, double& totalDistance) const;
     std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> exportGraph() const;
     void clear();
+    std::uint64_t generation() const;
 };
 
 #endif // NAVIGATION_GRAPH_H
@@ -0,0 +1,39 @@
+#ifndef NGRAM_INDEX_H
+#define NGRAM_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 地点名称的倒排 n-gram 索引（按 UTF-8 码点切分单字和二元组）。
+// 中文名称较短，二元组的倒排表已足够有选择性：子串查询先求各二元组倒排表的交集，
+// 再用保存的小写名称核对一遍，排除“二元组都出现但不相邻”的误报。
+// ASCII 字母不区分大小写，与 SearchManager::searchByName 的语义一致。
+class NgramIndex {
+private:
+    std::unordered_map<std::uint64_t, std::vector<int>> postings; // gram -> 升序 ID 列表
+    std::unordered_map<int, std::string> lowerNames;
+
+    static void insertSorted(std::vector<int>& list, int id);
+    static void eraseSorted(std::vector<int>& list, int id);
+
+public:
+    // 名称（已转小写并解码）的全部单字与二元组，去重后升序
+    static std::vector<std::uint64_t> nameGrams(const std::vector<char32_t>& codepoints);
+    // 子串查询所需的 gram：单字查询取单字，否则取相邻完整码点的二元组；
+    // 关键字含半个多字节字符时 partial 置为 true，命中后必须逐字节核对
+    static std::vector<std::uint64_t> queryGrams(const std::vector<char32_t>& codepoints, bool& partial);
+
+    void clear();
+    void add(int id, std::string_view name);
+    void remove(int id);
+    std::size_t size() const;
+
+    // 名称包含 keyword 的全部地点 ID（升序）；keyword 为空时返回全部 ID
+    std::vector<int> search(std::string_view keyword) const;
+};
+
+#endif // NGRAM_INDEX_H
@@ -0,0 +1,15 @@
+#ifndef PINYIN_INITIALS_H
+#define PINYIN_INITIALS_H
+
+#include <string>
+#include <string_view>
+
+// 单个汉字的拼音首字母（小写）；不在表中的字符返回 0
+char pinyinInitial(char32_t codepoint);
+
+// 名称的拼音首字母串，例如“图书馆3号” -> “tsg3h”。
+// ASCII 字母、数字转小写后原样保留，其他字符忽略；
+// 含常见多音字时展开为多个候选（最多 8 个），用 '|' 连接，如“银行” -> “yx|yh”
+std::string pinyinInitials(std::string_view name);
+
+#endif // PINYIN_INITIALS_H
@@ -0,0 +1,36 @@
+#ifndef POPULARITY_COUNTER_H
+#define POPULARITY_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 分片访问计数器：record() 可被多个线程同时调用。
+// 按地点 ID 散列到不同分片；已存在的计数项只需共享锁加一次原子加法，
+// 只有首次出现的 ID 才需要独占锁插入。drain() 一次性取走并清空全部增量。
+class PopularityCounter {
+private:
+    struct alignas(64) Shard {
+        std::shared_mutex mutex;
+        std::unordered_map<int, std::atomic<long long>> counters;
+    };
+
+    std::unique_ptr<Shard[]> shards;
+    std::size_t shardCount;
+    std::atomic<long long> pendingTotal{ 0 };
+
+    Shard& shardFor(int id);
+
+public:
+    explicit PopularityCounter(std::size_t shards = 16);
+
+    void record(int id, long long delta = 1);
+    long long pending() const;
+    std::vector<std::pair<int, long long>> drain();
+};
+
+#endif // POPULARITY_COUNTER_H
@@ -0,0 +1,43 @@
+#ifndef POPULARITY_LEADERBOARD_H
+#define POPULARITY_LEADERBOARD_H
+
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// 增量维护的人气排行索引：按 (人气降序, ID 升序) 有序存放。
+// 增加、删除、人气变化都是 O(log n)，取前 k 名只需顺序走 k 步。
+class PopularityLeaderboard {
+private:
+    struct Entry {
+        int popularity;
+        int id;
+    };
+
+    struct RankOrder {
+        bool operator()(const Entry& a, const Entry& b) const {
+            if (a.popularity != b.popularity) return a.popularity > b.popularity;
+            return a.id < b.id;
+        }
+    };
+
+    std::set<Entry, RankOrder> ordered;
+    std::unordered_map<int, int> popularityById;
+
+public:
+    void clear();
+    void reserve(std::size_t count);
+    void upsert(int id, int popularity);
+    void erase(int id);
+    bool contains(int id) const;
+    bool popularityOf(int id, int& popularity) const;
+    std::size_t size() const;
+
+    // 按名次顺序访问前 k 项；visitor 返回 false 时提前结束
+    void forEachTop(std::size_t k, const std::function<bool(int id, int popularity)>& visitor) const;
+    std::vector<int> topIds(std::size_t k) const;
+};
+
+#endif // POPULARITY_LEADERBOARD_H
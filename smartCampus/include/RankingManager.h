@@ -2,17 +2,68 @@
 #define RANKING_MANAGER_H
 
 #include "LocationManager.h"
+#include "PopularityLeaderboard.h"
+#include "TrendingScores.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 class RankingManager {
 private:
     LocationManager* locationManager;
-    void quickSort(std::vector<Location>& arr, int left, int right);
+
+    // 增量排行索引：按 LocationManager 的变更日志同步，只在日志截断时全量重建
+    std::mutex leaderboardMutex;
+    PopularityLeaderboard leaderboard;
+    std::uint64_t leaderboardGeneration = 0;
+    bool leaderboardReady = false;
+    // 近期热度：人气增量按其所在版本的发布时刻记为活动，按半衰期指数衰减
+    TrendingScores trending;
+    // 分类榜单：每个类型一份有序索引，与总榜同步更新
+    std::unordered_map<TypeId, PopularityLeaderboard> categoryBoards;
+    std::unordered_map<int, TypeId> typeById;
+
+    std::vector<std::size_t> fullRankingRows(const LocationSnapshot& snapshot) const;
+    void syncLeaderboard(const LocationSnapshot& snapshot);
+    void applyLocation(const LocationView& view, TrendingScores::Clock::time_point now);
+    void dropLocation(int id);
+    std::vector<LocationView> topViews(const LocationSnapshot& snapshot, std::size_t k);
+    std::vector<std::size_t> selectTopRows(const LocationSnapshot& snapshot, std::size_t k, TypeId typeFilter) const;
+    std::vector<Location> materialize(const LocationSnapshot& snapshot, const std::vector<std::size_t>& rows) const;
+    // 延迟加载模式下为结果补齐描述
+    void fillDescriptions(std::vector<Location>& locations) const;
+    std::vector<Location> materializeParallel(const LocationSnapshot& snapshot, const std::vector<std::size_t>& rows,
+                                              unsigned threads) const;
 
 public:
+    // 并行全量排序的最小行数：低于该规模时线程开销大于收益，直接走单线程基数排序。
+    // 多核上的加速比尚未实测，因此并行路径需要调用方显式给出线程数才会启用
+    static constexpr std::size_t kParallelRankThreshold = 1 << 16;
+
     RankingManager(LocationManager* lm);
+    // 全量排序：每次基于当前快照对行号做基数排序（同人气按 ID 升序），返回地点副本
     std::vector<Location> rankByPopularity();
+    // 并行全量排序：分段基数排序后两两归并，结果与 rankByPopularity 完全一致。
+    // 只有 threads > 1 且行数不少于 kParallelRankThreshold 时才会并行，否则与 rankByPopularity 相同
+    std::vector<Location> rankByPopularityParallel(unsigned threads);
+    // 排行榜视图：来自增量索引，结果在地点数据下一次修改前有效
+    std::vector<LocationView> rankedViews();
+    std::vector<LocationView> topViews(std::size_t k);
+    // 指定类型内的前 k 名（增量维护的分类榜单，O(k)）
+    std::vector<LocationView> topViewsByType(const std::string& type, std::size_t k);
     void printRanking();
+
+    // 部分选择：用大小为 k 的堆扫描一遍快照，只复制前 k 名（同人气按 ID 升序）
+    std::vector<Location> rankTopK(std::size_t k);
+    std::vector<Location> rankTopKByType(const std::string& type, std::size_t k);
+
+    // 近期热门：与累计人气排行并存，旧地标的历史人气会随时间衰减
+    std::vector<LocationView> trendingViews(std::size_t k);
+    // hours 必须为正数，否则抛出 std::invalid_argument，原有半衰期不变
+    void setTrendingHalfLife(double hours);
 };
 
 #endif // RANKING_MANAGER_H
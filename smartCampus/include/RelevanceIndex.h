@@ -0,0 +1,57 @@
+#ifndef RELEVANCE_INDEX_H
+#define RELEVANCE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 按人气排序的名称倒排索引，供带相关度的 top-k 名称搜索使用。
+// gram 的切分与 NgramIndex 相同，但每张倒排表按人气降序（同人气按 ID 升序）排列：
+// 查询只沿最短的一张表从人气高往低走，一旦剩余地点的得分上界进不了前 k 名就停止，
+// 不必给每个命中都打分。
+class RelevanceIndex {
+public:
+    enum class MatchKind { Exact, Prefix, Substring };
+
+    // 相关度 = 匹配质量（完全相同 4、前缀 2、子串 1）×人气加成 (1 + log10(1 + 人气))，人气为负按 0 计
+    static double score(MatchKind kind, int popularity);
+
+private:
+    struct Entry {
+        int popularity;
+        int id;
+    };
+
+    struct Item {
+        std::string lowerName;
+        int popularity;
+    };
+
+    std::unordered_map<std::uint64_t, std::vector<Entry>> impactLists; // gram -> 按人气降序
+    std::vector<Entry> allEntries; // 全部地点，关键字切不出 gram 时作为遍历入口
+    std::unordered_map<int, Item> items;
+
+    static bool ranksBefore(const Entry& a, const Entry& b);
+    static void insertEntry(std::vector<Entry>& list, const Entry& entry);
+    static void eraseEntry(std::vector<Entry>& list, const Entry& entry);
+    void insertItem(int id, const Item& item);
+    void eraseItem(int id, const Item& item);
+
+public:
+    void clear();
+    // 新增或更新地点（名称或人气变化均可）
+    void upsert(int id, std::string_view name, int popularity);
+    void remove(int id);
+    std::size_t size() const;
+
+    // 按人气从高到低遍历名称包含 keyword 但不以它开头的地点（ASCII 不区分大小写），交给 visitor。
+    // 每取出一个倒排项先调用 admits(人气, ID)，返回 false 表示之后的地点都不可能入选，遍历结束
+    void forEachInfixMatch(std::string_view keyword, const std::function<bool(int, int)>& admits,
+                           const std::function<void(int, int)>& visitor) const;
+};
+
+#endif // RELEVANCE_INDEX_H
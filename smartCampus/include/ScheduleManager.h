@@ -1,6 +1,8 @@
 #ifndef SCHEDULE_MANAGER_H
 #define SCHEDULE_MANAGER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -12,22 +14,34 @@ struct Activity {
     std::string description;
 };
 
+// 按开始时间（同时间按 ID）有序的活动集合，底层为 AVL 树：
+// 逐条插入与按时间有序的批量载入都不会退化成链表，递归深度保持 O(log n)。
 class ScheduleManager {
 private:
     struct Node {
         Activity data;
+        long long key = 0; // toKey(data.startTime)，插入时算一次
+        int height = 1;
         Node* left = nullptr;
         Node* right = nullptr;
     };
 
     Node* root = nullptr;
+    std::uint64_t generationCounter = 0; // 每次修改后加一
 
     static long long toKey(const std::string& timeStr);
-    static Node* insert(Node* node, const Activity& activity);
-    static void inOrder(Node* node, std::vector<Activity>& out);
-    static Node* removeExpired(Node* node, long long key);
-    static Node* mergeSubtrees(Node* left, Node* right);
-    static void preOrder(Node* node, std::vector<Activity>& out);
+    static bool comesBefore(long long key, int id, const Node* node);
+    static int heightOf(const Node* node);
+    static void updateHeight(Node* node);
+    static Node* rotateLeft(Node* node);
+    static Node* rotateRight(Node* node);
+    static Node* rebalance(Node* node);
+    static Node* insert(Node* node, Node* fresh);
+    // 由按序排列的节点建出平衡树，O(n)
+    static Node* buildBalanced(const std::vector<Node*>& nodes, std::size_t begin, std::size_t end);
+    static void collectNodes(Node* node, std::vector<Node*>& out);
+    static void inOrder(const Node* node, std::vector<Activity>& out);
+    static void preOrder(const Node* node, std::vector<Activity>& out);
     static void destroy(Node* node);
 
 public:
@@ -38,7 +52,9 @@ public:
     void clearExpired(const std::string& currentTime);
     std::vector<Activity> backup() const;
     void clear();
+    // 批量载入：输入已按时间有序（saveSchedule 的输出即如此）时直接 O(n) 建树，否则先排序
     void loadFromActivities(const std::vector<Activity>& activities);
+    std::uint64_t generation() const;
 };
 
 #endif // SCHEDULE_MANAGER_H
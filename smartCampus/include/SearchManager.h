@@ -2,19 +2,139 @@
 #define SEARCH_MANAGER_H
 
 #include "LocationManager.h"
+#include "BkTree.h"
+#include "CompletionTrie.h"
+#include "FilterIndex.h"
+#include "FullTextIndex.h"
+#include "LruCache.h"
+#include "NgramIndex.h"
+#include "RelevanceIndex.h"
+
+#include <climits>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
+// 组合查询条件，各条件之间为“且”关系
+struct LocationQuery {
+    std::string nameContains; // 名称包含的关键字，为空表示不限
+    std::string type;         // 类型，为空表示不限
+    int minPopularity = INT_MIN;
+    int maxPopularity = INT_MAX;
+};
+
 class SearchManager {
+public:
+    struct QueryCacheStats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t entries = 0;
+        std::size_t capacity = 0;
+
+        double hitRate() const;
+    };
+
 private:
+    friend class SearchSession;
+
+    using RowList = std::shared_ptr<const std::vector<std::size_t>>;
+
+    // 查询结果缓存：键为规范化后的关键字，结果只对记录时的数据代数有效
+    struct CachedQuery {
+        std::uint64_t generation = 0;
+        RowList rows;
+    };
+
     LocationManager* locationManager;
 
-    static std::string toLower(const std::string& text);
+    // 每个派生索引各自记录已同步到的数据代数
+    struct IndexState {
+        std::uint64_t generation = 0;
+        bool ready = false;
+    };
+
+    // 搜索索引按 LocationManager 的变更日志增量维护，只在用到它的查询中才同步，
+    // 名称搜索不必为容错、拼音、全文等索引付出建立和重放的代价
+    mutable std::mutex indexMutex;
+    mutable NgramIndex nameIndex;
+    mutable RelevanceIndex rankIndex; // 与 nameIndex 一同启用
+    mutable CompletionTrie completions;
+    mutable BkTree fuzzyIndex;
+    mutable FullTextIndex fullText;
+    mutable FilterIndex filterIndex;
+    mutable NgramIndex pinyinIndex; // 名称的拼音首字母串
+    mutable IndexState nameState;
+    mutable IndexState rankState;
+    mutable IndexState completionState;
+    mutable IndexState fuzzyState;
+    mutable IndexState fullTextState;
+    mutable IndexState filterState;
+    mutable IndexState pinyinState;
+    bool nameIndexing = true; // 受 indexMutex 保护
+
+    mutable std::mutex cacheMutex;
+    mutable LruCache<std::string, CachedQuery> queryCache{128};
+    mutable std::size_t cacheHits = 0;
+    mutable std::size_t cacheMisses = 0;
+
+    // 把一个索引同步到 snapshot：按变更日志重放（仍存在的交给 upsert，已删除的交给 drop），
+    // 尚未建立或日志已截断时先 reset 再全量重建。调用方需持有 indexMutex
+    void syncIndex(const LocationSnapshot& snapshot, IndexState& state, const std::function<void()>& reset,
+                   const std::function<void(const LocationView&)>& upsert,
+                   const std::function<void(int)>& drop) const;
+    void syncNameIndex(const LocationSnapshot& snapshot) const;
+    void syncRankIndex(const LocationSnapshot& snapshot) const;
+    void syncCompletions(const LocationSnapshot& snapshot) const;
+    void syncFuzzyIndex(const LocationSnapshot& snapshot) const;
+    void syncFilterIndex(const LocationSnapshot& snapshot) const;
+    void syncPinyinIndex(const LocationSnapshot& snapshot) const;
+    // 全文索引单独处理：延迟加载描述时需要读数据文件，只改人气的变更不读描述
+    void syncFullText(const LocationSnapshot& snapshot) const;
+    void indexText(const LocationView& view) const;
+    // 把命中的 ID 换成快照中的行号并按存储顺序排列
+    static std::vector<std::size_t> rowsInOrder(const LocationSnapshot& snapshot, const std::vector<int>& ids);
+    // 名称包含 keyword 的行号（存储顺序），keyword 不能为空；先查结果缓存
+    RowList matchingRows(const LocationSnapshot& snapshot, const std::string& keyword) const;
+    std::vector<std::size_t> computeMatchingRows(const LocationSnapshot& snapshot, const std::string& keyword) const;
 
 public:
     explicit SearchManager(LocationManager* lm);
 
     std::vector<Location> searchByName(const std::string& keyword) const;
+    // 分页流式搜索：跳过前 offset 个命中，最多把 limit 个交给 visitor，返回命中总数。
+    // 视图只在回调期间有效；keyword 为空时按存储顺序遍历全部地点
+    std::size_t searchByName(const std::string& keyword, std::size_t offset, std::size_t limit,
+                             const std::function<void(const LocationView&)>& visitor) const;
+    // 只返回命中地点的 ID（存储顺序），不复制地点数据
+    std::vector<int> searchIdsByName(const std::string& keyword) const;
+
+    // 名称搜索结果缓存，容量为 0 时关闭
+    void setQueryCacheCapacity(std::size_t capacity);
+    QueryCacheStats queryCacheStats() const;
+    void resetQueryCacheStats();
+
+    // 组合查询：按存储顺序分页返回满足全部条件的地点，返回命中总数；视图只在回调期间有效
+    std::size_t findLocations(const LocationQuery& query, std::size_t offset, std::size_t limit,
+                              const std::function<void(const LocationView&)>& visitor) const;
+    std::vector<Location> findLocations(const LocationQuery& query) const;
+    // 关闭后 searchByName 不再维护 n-gram 索引，改为逐条原地扫描名称（省内存，适合数据量小或很少搜索时）
+    void setNameIndexing(bool enabled);
+    bool nameIndexingEnabled() const;
+    // 输入联想：名称以 prefix 开头的地点，按人气从高到低取前 k 个
+    std::vector<Location> suggest(const std::string& prefix, std::size_t k = 8) const;
+    // 按名称精确查找（区分大小写），经补全字典树定位，不扫描全部地点；同名时取存储顺序最前者
+    bool findIdByName(const std::string& name, int& id) const;
+    // 容错搜索：名称与 keyword 的编辑距离不超过 maxDistance，按距离升序、人气降序返回前 limit 个
+    std::vector<Location> fuzzySearch(const std::string& keyword, int maxDistance = 1, std::size_t limit = 20) const;
+    // 拼音首字母搜索：“tsg”可找到“图书馆”，结果按存储顺序
+    std::vector<Location> searchByPinyin(const std::string& initials) const;
+    // 相关度排序的名称搜索：完全相同优于前缀优于子串，再乘以人气加成，按得分降序取前 k 个（同分时人气高者、ID 小者在前）
+    std::vector<Location> rankedSearch(const std::string& keyword, std::size_t k = 10) const;
+    // 全文检索：在名称、类型、描述中查找，按 BM25 与人气的综合得分返回前 k 个
+    std::vector<Location> fullTextSearch(const std::string& query, std::size_t k = 10) const;
 };
 
 #endif // SEARCH_MANAGER_H
@@ -0,0 +1,43 @@
+#ifndef SEARCH_SESSION_H
+#define SEARCH_SESSION_H
+
+#include "LocationSnapshot.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SearchManager;
+
+// 边输入边搜索的会话：新关键字包含上一次的关键字时（例如在末尾多输入一个字），
+// 命中集合只会缩小，直接在上一次的结果里筛选；否则回到 SearchManager 完整查找。
+// 会话持有所用的快照，结果与视图在下一次 update 前保持有效。一个会话只供一个线程使用。
+class SearchSession {
+private:
+    const SearchManager* searchManager;
+    std::shared_ptr<const LocationSnapshot> snapshot;
+    std::string lowerKeyword;
+    std::vector<std::size_t> rows;
+    bool started = false;
+    std::size_t refinedCount = 0;
+    std::size_t fullLookupCount = 0;
+
+public:
+    explicit SearchSession(const SearchManager& manager);
+
+    // 输入内容变化时调用，返回当前命中数
+    std::size_t update(const std::string& keyword);
+    void reset();
+
+    std::size_t size() const;
+    std::vector<int> ids() const;
+    // 按存储顺序分页访问当前结果
+    void visit(std::size_t offset, std::size_t limit, const std::function<void(const LocationView&)>& visitor) const;
+
+    std::size_t refinements() const;
+    std::size_t fullLookups() const;
+};
+
+#endif // SEARCH_SESSION_H
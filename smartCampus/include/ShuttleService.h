@@ -2,6 +2,7 @@
 #define SHUTTLE_SERVICE_H
 
 #include "myqueue.h"
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -32,6 +33,7 @@ private:
     std::unordered_map<std::string, MyQueue<std::string>> stationQueues;  ///< 各站点的乘客排队队列
     std::vector<std::string> onboardPassengers;                             ///< 当前车上的乘客列表
     std::vector<std::string> dropoffHistory;                                ///< 乘客下车历史记录
+    std::uint64_t generationCounter = 0;                                    ///< 变更代数，每次修改后加一
 
 public:
     /**
@@ -124,6 +126,15 @@ public:
      * 会清空当前所有数据后重新加载。
      */
     void loadState(const ShuttlePersistentState& state);
+
+    /**
+     * @brief 获取当前变更代数
+     * @return 单调递增的代数值
+     * 
+     * 每个修改状态的方法都会使代数加一，调用方保存上次看到的代数，
+     * 比较即可在 O(1) 时间内判断派生数据是否需要重新计算。
+     */
+    std::uint64_t generation() const;
 };
 
 #endif // SHUTTLE_SERVICE_H
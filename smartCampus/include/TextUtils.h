@@ -0,0 +1,23 @@
+#ifndef TEXT_UTILS_H
+#define TEXT_UTILS_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// UTF-8 解码：返回码点序列。非法字节不会丢弃，而是映射为 0x110000 + 字节值，
+// 保证同一段文本总能得到相同的结果。
+std::vector<char32_t> decodeUtf8(std::string_view text);
+void appendUtf8(std::string& out, char32_t codepoint);
+// 去掉末尾被截断的多字节字符后剩余的字节数；文本完整时返回 text.size()
+std::size_t completeUtf8Length(std::string_view text);
+
+// 只转换 ASCII 字母的小写形式，多字节字符原样保留
+std::string asciiLower(std::string_view text);
+
+// 全文检索分词：ASCII 字母数字连续段作为一个词（转小写），
+// 连续的中日韩文字切成相邻二元组（单个汉字时保留单字），其余字符视为分隔符
+void tokenizeText(std::string_view text, std::vector<std::string>& tokens);
+
+#endif // TEXT_UTILS_H
@@ -0,0 +1,51 @@
+#ifndef TRENDING_SCORES_H
+#define TRENDING_SCORES_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+// 指数时间衰减的热度分数。
+// 不逐项衰减：所有分数以基准时刻 base 为单位存放，新增活动按 e^{λ(t-base)} 放大后累加，
+// 读取时统一乘以 e^{-λ(now-base)}。公共因子不改变先后次序，因此有序索引无需重排；
+// 放大系数过大时才整体换算一次基准时刻。
+class TrendingScores {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    struct ByScore {
+        bool operator()(const std::pair<double, int>& a, const std::pair<double, int>& b) const {
+            if (a.first != b.first) return a.first > b.first;
+            return a.second < b.second;
+        }
+    };
+
+    double decayRate;                  // λ = ln2 / 半衰期（秒）
+    Clock::time_point base;
+    std::set<std::pair<double, int>, ByScore> ordered;
+    std::unordered_map<int, double> scaledById;
+
+    double elapsedSeconds(Clock::time_point now) const;
+    void rebase(Clock::time_point now);
+
+public:
+    // 半衰期必须为正数，否则抛出 std::invalid_argument
+    explicit TrendingScores(double halfLifeSeconds = 24.0 * 3600.0);
+
+    void setHalfLife(double halfLifeSeconds, Clock::time_point now = Clock::now());
+    void addActivity(int id, double amount, Clock::time_point now = Clock::now());
+    void erase(int id);
+    void clear();
+    std::size_t size() const;
+
+    double score(int id, Clock::time_point now = Clock::now()) const;
+    // 按当前热度从高到低访问前 k 项；visitor 返回 false 时提前结束
+    void forEachTop(std::size_t k, const std::function<bool(int id, double score)>& visitor,
+                    Clock::time_point now = Clock::now()) const;
+};
+
+#endif // TRENDING_SCORES_H
@@ -0,0 +1,34 @@
+#ifndef TYPE_DICTIONARY_H
+#define TYPE_DICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using TypeId = std::uint32_t;
+
+// 地点类型字典：把重复出现的类型字符串映射为从 0 开始的小整数编号。
+// 编号只增不减，名称存放在 deque 中，已返回的引用/视图在 clear() 前一直有效。
+class TypeDictionary {
+private:
+    std::deque<std::string> names;
+    std::unordered_map<std::string_view, TypeId> ids;
+
+public:
+    static constexpr TypeId kInvalidType = static_cast<TypeId>(-1);
+
+    TypeDictionary() = default;
+    TypeDictionary(const TypeDictionary& other);
+    TypeDictionary& operator=(const TypeDictionary& other);
+
+    TypeId intern(std::string_view type);
+    TypeId find(std::string_view type) const;
+    const std::string& name(TypeId id) const;
+    std::size_t size() const;
+    void clear();
+};
+
+#endif // TYPE_DICTIONARY_H
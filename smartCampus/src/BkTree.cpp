@@ -0,0 +1,149 @@
+#include "BkTree.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+
+std::u32string BkTree::toKey(const std::string& lowerName) {
+    auto codepoints = decodeUtf8(lowerName);
+    return std::u32string(codepoints.begin(), codepoints.end());
+}
+
+int BkTree::distance(const std::u32string& a, const std::u32string& b, int limit) {
+    int lengthGap = static_cast<int>(a.size()) - static_cast<int>(b.size());
+    if (lengthGap > limit || -lengthGap > limit) return limit + 1;
+    // 名称通常很短，两行 DP 放在栈上，避免每次比较都分配内存
+    constexpr std::size_t kInlineColumns = 64;
+    int inlineRows[2 * kInlineColumns];
+    std::vector<int> heapRows;
+    int* previous = inlineRows;
+    if (b.size() + 1 > kInlineColumns) {
+        heapRows.resize(2 * (b.size() + 1));
+        previous = heapRows.data();
+    }
+    int* row = previous + (b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); ++j) {
+        previous[j] = static_cast<int>(j);
+    }
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        row[0] = static_cast<int>(i);
+        int rowMin = row[0];
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            int substitute = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+            row[j] = std::min({previous[j] + 1, row[j - 1] + 1, substitute});
+            rowMin = std::min(rowMin, row[j]);
+        }
+        if (rowMin > limit) return limit + 1; // 整行都已超限，后续只会更大
+        std::swap(previous, row);
+    }
+    return std::min(previous[b.size()], limit + 1);
+}
+
+void BkTree::insertName(const std::string& lowerName, int id) {
+    auto existing = nodeByName.find(lowerName);
+    if (existing != nodeByName.end()) {
+        auto& ids = nodes[existing->second].ids;
+        if (ids.empty()) --emptyNodes;
+        ids.push_back(id);
+        return;
+    }
+    auto created = static_cast<std::uint32_t>(nodes.size());
+    Node node;
+    node.key = toKey(lowerName);
+    node.ids.push_back(id);
+    if (!nodes.empty()) {
+        std::uint32_t current = 0;
+        while (true) {
+            const auto& key = nodes[current].key;
+            int limit = static_cast<int>(std::max(key.size(), node.key.size()));
+            int d = distance(node.key, key, limit);
+            auto& children = nodes[current].children;
+            auto it = std::find_if(children.begin(), children.end(),
+                                   [d](const std::pair<int, std::uint32_t>& c) { return c.first == d; });
+            if (it == children.end()) {
+                children.emplace_back(d, created);
+                break;
+            }
+            current = it->second;
+        }
+    }
+    nodes.push_back(std::move(node));
+    nodeByName.emplace(lowerName, created);
+}
+
+void BkTree::rebuild() {
+    std::vector<std::pair<std::string, int>> live;
+    live.reserve(nameById.size());
+    for (const auto& kv : nameById) {
+        live.emplace_back(kv.second, kv.first);
+    }
+    // 按名称排序让同名地点连续插入，重建结果也与哈希表遍历顺序无关
+    std::sort(live.begin(), live.end());
+    nodes.clear();
+    nodeByName.clear();
+    emptyNodes = 0;
+    for (const auto& entry : live) {
+        insertName(entry.first, entry.second);
+    }
+}
+
+void BkTree::clear() {
+    nodes.clear();
+    nodeByName.clear();
+    nameById.clear();
+    emptyNodes = 0;
+}
+
+void BkTree::add(int id, std::string_view name) {
+    std::string lowered = asciiLower(name);
+    auto it = nameById.find(id);
+    if (it != nameById.end()) {
+        if (it->second == lowered) return;
+        remove(id);
+    }
+    insertName(lowered, id);
+    nameById.emplace(id, std::move(lowered));
+}
+
+void BkTree::remove(int id) {
+    auto it = nameById.find(id);
+    if (it == nameById.end()) return;
+    auto& ids = nodes[nodeByName.at(it->second)].ids;
+    ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+    if (ids.empty()) ++emptyNodes;
+    nameById.erase(it);
+    if (emptyNodes > 64 && emptyNodes > nodes.size() / 2) {
+        rebuild();
+    }
+}
+
+std::size_t BkTree::size() const {
+    return nameById.size();
+}
+
+std::vector<std::pair<int, int>> BkTree::search(std::string_view keyword, int maxDistance) const {
+    std::vector<std::pair<int, int>> found;
+    if (nodes.empty() || maxDistance < 0) return found;
+    std::u32string query = toKey(asciiLower(keyword));
+    std::vector<std::uint32_t> pending{0};
+    while (!pending.empty()) {
+        const Node& node = nodes[pending.back()];
+        pending.pop_back();
+        // 子节点边权都不超过 maxEdge，距离算到 maxEdge + maxDistance 即可决定路由
+        int maxEdge = 0;
+        for (const auto& c : node.children) {
+            maxEdge = std::max(maxEdge, c.first);
+        }
+        int d = distance(query, node.key, maxEdge + maxDistance);
+        if (d <= maxDistance) {
+            for (int id : node.ids) {
+                found.emplace_back(d, id);
+            }
+        }
+        for (const auto& c : node.children) {
+            if (c.first >= d - maxDistance && c.first <= d + maxDistance) {
+                pending.push_back(c.second);
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,109 @@
+#include "CaseInsensitiveSearch.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define SMART_CAMPUS_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+inline unsigned char foldByte(unsigned char ch) {
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<unsigned char>(ch | 0x20) : ch;
+}
+
+inline bool equalsFolded(const char* a, const char* b, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+        if (foldByte(static_cast<unsigned char>(a[i])) != foldByte(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 从 start 开始逐个位置比较，SIMD 版本处理不足一个向量的尾部时也用它
+bool scalarContains(std::string_view text, std::string_view keyword, std::size_t start) {
+    const std::size_t n = keyword.size();
+    for (std::size_t i = start; i + n <= text.size(); ++i) {
+        if (equalsFolded(text.data() + i, keyword.data(), n)) return true;
+    }
+    return false;
+}
+
+#ifdef SMART_CAMPUS_X86_SIMD
+// 先用向量比较关键字的首尾两个字节筛出候选位置，再逐个核对中间部分
+inline __m128i foldSse2(__m128i block) {
+    const __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                                        _mm_cmplt_epi8(block, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(block, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+bool sse2Contains(std::string_view text, std::string_view keyword) {
+    const std::size_t n = keyword.size();
+    const __m128i first = _mm_set1_epi8(static_cast<char>(foldByte(static_cast<unsigned char>(keyword.front()))));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(foldByte(static_cast<unsigned char>(keyword.back()))));
+    std::size_t i = 0;
+    for (; i + n - 1 + 16 <= text.size(); i += 16) {
+        const __m128i blockFirst = foldSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i)));
+        const __m128i blockLast =
+            foldSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i + n - 1)));
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (n <= 2 || equalsFolded(text.data() + i + bit + 1, keyword.data() + 1, n - 2)) return true;
+            mask &= mask - 1;
+        }
+    }
+    return scalarContains(text, keyword, i);
+}
+
+__attribute__((target("avx2"))) inline __m256i foldAvx2(__m256i block) {
+    const __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8('A' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), block));
+    return _mm256_or_si256(block, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+__attribute__((target("avx2"))) bool avx2Contains(std::string_view text, std::string_view keyword) {
+    const std::size_t n = keyword.size();
+    const __m256i first =
+        _mm256_set1_epi8(static_cast<char>(foldByte(static_cast<unsigned char>(keyword.front()))));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(foldByte(static_cast<unsigned char>(keyword.back()))));
+    std::size_t i = 0;
+    for (; i + n - 1 + 32 <= text.size(); i += 32) {
+        const __m256i blockFirst =
+            foldAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i)));
+        const __m256i blockLast =
+            foldAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + i + n - 1)));
+        auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (n <= 2 || equalsFolded(text.data() + i + bit + 1, keyword.data() + 1, n - 2)) return true;
+            mask &= mask - 1;
+        }
+    }
+    return scalarContains(text, keyword, i);
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+} // namespace
+
+bool containsIgnoreCase(std::string_view text, std::string_view keyword) {
+    if (keyword.empty()) return true;
+    if (keyword.size() > text.size()) return false;
+#ifdef SMART_CAMPUS_X86_SIMD
+    // 文本放不下一个完整向量时，广播常量和 AVX/SSE 状态切换的开销比逐字节比较还大
+    const std::size_t span = text.size() - keyword.size() + 1;
+    if (span >= 32 && cpuHasAvx2()) return avx2Contains(text, keyword);
+    if (span >= 16) return sse2Contains(text, keyword);
+    return scalarContains(text, keyword, 0);
+#else
+    return scalarContains(text, keyword, 0);
+#endif
+}
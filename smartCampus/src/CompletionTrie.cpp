@@ -0,0 +1,203 @@
+#include "CompletionTrie.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+
+CompletionTrie::CompletionTrie() : nodes(1) {}
+
+bool CompletionTrie::ranksBefore(const Entry& a, const Entry& b) {
+    if (a.popularity != b.popularity) return a.popularity > b.popularity;
+    return a.id < b.id;
+}
+
+std::uint32_t CompletionTrie::child(std::uint32_t node, char32_t cp) const {
+    const auto& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), cp,
+                               [](const std::pair<char32_t, std::uint32_t>& c, char32_t key) { return c.first < key; });
+    if (it == children.end() || it->first != cp) return 0;
+    return it->second;
+}
+
+std::uint32_t CompletionTrie::childOrCreate(std::uint32_t node, char32_t cp) {
+    std::uint32_t existing = child(node, cp);
+    if (existing != 0) return existing;
+    auto created = static_cast<std::uint32_t>(nodes.size());
+    nodes.emplace_back();
+    auto& children = nodes[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), cp,
+                               [](const std::pair<char32_t, std::uint32_t>& c, char32_t key) { return c.first < key; });
+    children.insert(it, {cp, created});
+    return created;
+}
+
+std::vector<std::uint32_t> CompletionTrie::pathOf(const std::string& lowerName, bool create) {
+    std::vector<std::uint32_t> path{0};
+    for (char32_t cp : decodeUtf8(lowerName)) {
+        std::uint32_t next = create ? childOrCreate(path.back(), cp) : child(path.back(), cp);
+        if (next == 0) return {};
+        path.push_back(next);
+    }
+    return path;
+}
+
+void CompletionTrie::refresh(std::uint32_t node) {
+    if (!nodes[node].dirty) return;
+    std::vector<Entry> merged;
+    for (int id : nodes[node].terminals) {
+        merged.push_back({items.at(id).popularity, id});
+    }
+    for (std::size_t i = 0; i < nodes[node].children.size(); ++i) {
+        std::uint32_t next = nodes[node].children[i].second;
+        refresh(next);
+        merged.insert(merged.end(), nodes[next].top.begin(), nodes[next].top.end());
+    }
+    std::size_t keep = std::min(merged.size(), kCachedCount);
+    std::partial_sort(merged.begin(), merged.begin() + keep, merged.end(), ranksBefore);
+    merged.resize(keep);
+    nodes[node].top = std::move(merged);
+    nodes[node].dirty = false;
+}
+
+void CompletionTrie::collect(std::uint32_t node, std::vector<Entry>& out) {
+    for (int id : nodes[node].terminals) {
+        out.push_back({items.at(id).popularity, id});
+    }
+    for (const auto& c : nodes[node].children) {
+        collect(c.second, out);
+    }
+}
+
+void CompletionTrie::insertItem(int id, const Item& item) {
+    auto path = pathOf(item.lowerName, true);
+    nodes[path.back()].terminals.push_back(id);
+    Entry entry{item.popularity, id};
+    for (std::uint32_t node : path) {
+        auto& top = nodes[node].top;
+        if (nodes[node].dirty) continue; // 重算时会把它合并进来
+        auto it = std::lower_bound(top.begin(), top.end(), entry, ranksBefore);
+        if (static_cast<std::size_t>(it - top.begin()) >= kCachedCount) continue;
+        top.insert(it, entry);
+        if (top.size() > kCachedCount) top.pop_back();
+    }
+}
+
+void CompletionTrie::eraseItem(int id, const Item& item) {
+    auto path = pathOf(item.lowerName, false);
+    if (path.empty()) return;
+    auto& terminals = nodes[path.back()].terminals;
+    terminals.erase(std::remove(terminals.begin(), terminals.end(), id), terminals.end());
+    for (std::uint32_t node : path) {
+        auto& top = nodes[node].top;
+        auto it = std::find_if(top.begin(), top.end(), [id](const Entry& e) { return e.id == id; });
+        if (it == top.end()) continue;
+        // 缓存未满说明它就是子树的全部内容，直接删除；否则需要从子节点补位
+        bool complete = top.size() < kCachedCount;
+        top.erase(it);
+        if (!complete) nodes[node].dirty = true;
+    }
+}
+
+void CompletionTrie::clear() {
+    nodes.assign(1, Node{});
+    items.clear();
+}
+
+void CompletionTrie::upsert(int id, std::string_view name, int popularity) {
+    Item next{asciiLower(name), popularity};
+    auto it = items.find(id);
+    if (it == items.end()) {
+        insertItem(id, next);
+        items.emplace(id, std::move(next));
+        return;
+    }
+    Item& current = it->second;
+    if (current.lowerName == next.lowerName && current.popularity == next.popularity) return;
+    if (current.lowerName == next.lowerName && next.popularity > current.popularity) {
+        // 访问计数只会让人气上升：名次只前移，路径上的缓存就地调整即可
+        current.popularity = next.popularity;
+        Entry entry{next.popularity, id};
+        for (std::uint32_t node : pathOf(current.lowerName, false)) {
+            if (nodes[node].dirty) continue;
+            auto& top = nodes[node].top;
+            auto old = std::find_if(top.begin(), top.end(), [id](const Entry& e) { return e.id == id; });
+            if (old != top.end()) top.erase(old);
+            auto pos = std::lower_bound(top.begin(), top.end(), entry, ranksBefore);
+            if (static_cast<std::size_t>(pos - top.begin()) >= kCachedCount) continue;
+            top.insert(pos, entry);
+            if (top.size() > kCachedCount) top.pop_back();
+        }
+        return;
+    }
+    eraseItem(id, current);
+    current = std::move(next);
+    insertItem(id, current);
+}
+
+void CompletionTrie::remove(int id) {
+    auto it = items.find(id);
+    if (it == items.end()) return;
+    eraseItem(id, it->second);
+    items.erase(it);
+}
+
+std::size_t CompletionTrie::size() const {
+    return items.size();
+}
+
+std::vector<int> CompletionTrie::complete(std::string_view prefix, std::size_t k) {
+    std::vector<int> ids;
+    std::string lowered = asciiLower(prefix);
+    std::size_t whole = completeUtf8Length(lowered);
+    std::uint32_t node = 0;
+    for (char32_t cp : decodeUtf8(std::string_view(lowered).substr(0, whole))) {
+        node = child(node, cp);
+        if (node == 0) return ids;
+    }
+
+    // 前缀末尾是半个多字节字符时，编码以这些字节开头的子节点都算命中
+    std::vector<std::uint32_t> starts;
+    if (whole == lowered.size()) {
+        starts.push_back(node);
+    } else {
+        std::string_view tail = std::string_view(lowered).substr(whole);
+        for (const auto& c : nodes[node].children) {
+            std::string encoded;
+            appendUtf8(encoded, c.first);
+            if (encoded.compare(0, tail.size(), tail) == 0) {
+                starts.push_back(c.second);
+            }
+        }
+    }
+
+    std::vector<Entry> merged;
+    bool truncated = false;
+    for (std::uint32_t start : starts) {
+        refresh(start);
+        const auto& top = nodes[start].top;
+        merged.insert(merged.end(), top.begin(), top.end());
+        if (top.size() >= kCachedCount && k > top.size()) truncated = true;
+    }
+    if (truncated) {
+        // 超出缓存长度时退回到遍历整棵子树
+        merged.clear();
+        for (std::uint32_t start : starts) {
+            collect(start, merged);
+        }
+    }
+    std::size_t count = std::min(k, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + count, merged.end(), ranksBefore);
+    ids.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        ids.push_back(merged[i].id);
+    }
+    return ids;
+}
+
+std::vector<int> CompletionTrie::exactMatches(std::string_view name) const {
+    std::uint32_t node = 0;
+    for (char32_t cp : decodeUtf8(asciiLower(name))) {
+        node = child(node, cp);
+        if (node == 0) return {};
+    }
+    return nodes[node].terminals;
+}
@@ -0,0 +1,218 @@
+#include "CompressedBitmap.h"
+
+#include <algorithm>
+#include <iterator>
+
+std::vector<CompressedBitmap::Container>::iterator CompressedBitmap::findContainer(std::uint16_t key) {
+    return std::lower_bound(containers.begin(), containers.end(), key,
+                            [](const Container& c, std::uint16_t k) { return c.key < k; });
+}
+
+std::vector<CompressedBitmap::Container>::const_iterator CompressedBitmap::findContainer(std::uint16_t key) const {
+    return std::lower_bound(containers.begin(), containers.end(), key,
+                            [](const Container& c, std::uint16_t k) { return c.key < k; });
+}
+
+void CompressedBitmap::toBitset(Container& c) {
+    c.bits.assign(kBitsetWords, 0);
+    for (std::uint16_t low : c.array) {
+        c.bits[low >> 6] |= 1ULL << (low & 63);
+    }
+    c.array.clear();
+    c.array.shrink_to_fit();
+}
+
+void CompressedBitmap::toArray(Container& c) {
+    c.array.clear();
+    c.array.reserve(c.count);
+    for (std::size_t w = 0; w < kBitsetWords; ++w) {
+        std::uint64_t word = c.bits[w];
+        while (word != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctzll(word));
+            c.array.push_back(static_cast<std::uint16_t>(w * 64 + bit));
+            word &= word - 1;
+        }
+    }
+    c.bits.clear();
+    c.bits.shrink_to_fit();
+}
+
+CompressedBitmap::Container CompressedBitmap::intersect(const Container& a, const Container& b) {
+    Container out;
+    out.key = a.key;
+    if (a.isBitset() && b.isBitset()) {
+        out.bits.resize(kBitsetWords);
+        for (std::size_t w = 0; w < kBitsetWords; ++w) {
+            out.bits[w] = a.bits[w] & b.bits[w];
+            out.count += static_cast<std::uint32_t>(__builtin_popcountll(out.bits[w]));
+        }
+        if (out.count <= kArrayLimit) toArray(out);
+    } else if (a.isBitset() || b.isBitset()) {
+        const Container& dense = a.isBitset() ? a : b;
+        const Container& sparse = a.isBitset() ? b : a;
+        for (std::uint16_t low : sparse.array) {
+            if (dense.bits[low >> 6] & (1ULL << (low & 63))) {
+                out.array.push_back(low);
+            }
+        }
+        out.count = static_cast<std::uint32_t>(out.array.size());
+    } else {
+        std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                              std::back_inserter(out.array));
+        out.count = static_cast<std::uint32_t>(out.array.size());
+    }
+    return out;
+}
+
+CompressedBitmap::Container CompressedBitmap::unite(const Container& a, const Container& b) {
+    Container out;
+    out.key = a.key;
+    if (!a.isBitset() && !b.isBitset() && a.array.size() + b.array.size() <= kArrayLimit) {
+        std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(), std::back_inserter(out.array));
+        out.count = static_cast<std::uint32_t>(out.array.size());
+        return out;
+    }
+    out.bits.assign(kBitsetWords, 0);
+    for (const Container* part : {&a, &b}) {
+        if (part->isBitset()) {
+            for (std::size_t w = 0; w < kBitsetWords; ++w) {
+                out.bits[w] |= part->bits[w];
+            }
+        } else {
+            for (std::uint16_t low : part->array) {
+                out.bits[low >> 6] |= 1ULL << (low & 63);
+            }
+        }
+    }
+    for (std::uint64_t word : out.bits) {
+        out.count += static_cast<std::uint32_t>(__builtin_popcountll(word));
+    }
+    if (out.count <= kArrayLimit) toArray(out);
+    return out;
+}
+
+CompressedBitmap CompressedBitmap::fromSorted(const std::vector<std::uint32_t>& values) {
+    CompressedBitmap bitmap;
+    for (std::size_t i = 0; i < values.size();) {
+        Container c;
+        c.key = static_cast<std::uint16_t>(values[i] >> 16);
+        for (; i < values.size() && (values[i] >> 16) == c.key; ++i) {
+            auto low = static_cast<std::uint16_t>(values[i] & 0xFFFF);
+            if (c.array.empty() || c.array.back() != low) c.array.push_back(low);
+        }
+        c.count = static_cast<std::uint32_t>(c.array.size());
+        if (c.count > kArrayLimit) toBitset(c);
+        bitmap.containers.push_back(std::move(c));
+    }
+    return bitmap;
+}
+
+void CompressedBitmap::add(std::uint32_t value) {
+    auto key = static_cast<std::uint16_t>(value >> 16);
+    auto low = static_cast<std::uint16_t>(value & 0xFFFF);
+    auto it = findContainer(key);
+    if (it == containers.end() || it->key != key) {
+        it = containers.insert(it, Container{});
+        it->key = key;
+    }
+    Container& c = *it;
+    if (c.isBitset()) {
+        std::uint64_t mask = 1ULL << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) {
+            c.bits[low >> 6] |= mask;
+            ++c.count;
+        }
+        return;
+    }
+    auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+    if (pos != c.array.end() && *pos == low) return;
+    c.array.insert(pos, low);
+    ++c.count;
+    if (c.count > kArrayLimit) toBitset(c);
+}
+
+void CompressedBitmap::remove(std::uint32_t value) {
+    auto key = static_cast<std::uint16_t>(value >> 16);
+    auto low = static_cast<std::uint16_t>(value & 0xFFFF);
+    auto it = findContainer(key);
+    if (it == containers.end() || it->key != key) return;
+    Container& c = *it;
+    if (c.isBitset()) {
+        std::uint64_t mask = 1ULL << (low & 63);
+        if (!(c.bits[low >> 6] & mask)) return;
+        c.bits[low >> 6] &= ~mask;
+        --c.count;
+        if (c.count < kBitsetLowWater) toArray(c);
+    } else {
+        auto pos = std::lower_bound(c.array.begin(), c.array.end(), low);
+        if (pos == c.array.end() || *pos != low) return;
+        c.array.erase(pos);
+        --c.count;
+    }
+    if (c.count == 0) containers.erase(it);
+}
+
+bool CompressedBitmap::contains(std::uint32_t value) const {
+    auto key = static_cast<std::uint16_t>(value >> 16);
+    auto low = static_cast<std::uint16_t>(value & 0xFFFF);
+    auto it = findContainer(key);
+    if (it == containers.end() || it->key != key) return false;
+    if (it->isBitset()) return (it->bits[low >> 6] >> (low & 63)) & 1ULL;
+    return std::binary_search(it->array.begin(), it->array.end(), low);
+}
+
+std::size_t CompressedBitmap::cardinality() const {
+    std::size_t total = 0;
+    for (const auto& c : containers) {
+        total += c.count;
+    }
+    return total;
+}
+
+bool CompressedBitmap::empty() const {
+    return containers.empty();
+}
+
+void CompressedBitmap::clear() {
+    containers.clear();
+}
+
+CompressedBitmap& CompressedBitmap::operator&=(const CompressedBitmap& other) {
+    std::vector<Container> result;
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() && b != other.containers.end()) {
+        if (a->key < b->key) {
+            ++a;
+        } else if (b->key < a->key) {
+            ++b;
+        } else {
+            Container c = intersect(*a, *b);
+            if (c.count > 0) result.push_back(std::move(c));
+            ++a;
+            ++b;
+        }
+    }
+    containers.swap(result);
+    return *this;
+}
+
+CompressedBitmap& CompressedBitmap::operator|=(const CompressedBitmap& other) {
+    std::vector<Container> result;
+    result.reserve(containers.size() + other.containers.size());
+    auto a = containers.begin();
+    auto b = other.containers.begin();
+    while (a != containers.end() || b != other.containers.end()) {
+        if (b == other.containers.end() || (a != containers.end() && a->key < b->key)) {
+            result.push_back(std::move(*a++));
+        } else if (a == containers.end() || b->key < a->key) {
+            result.push_back(*b++);
+        } else {
+            result.push_back(unite(*a, *b));
+            ++a;
+            ++b;
+        }
+    }
+    containers.swap(result);
+    return *this;
+}
@@ -0,0 +1,158 @@
+#include "FilterIndex.h"
+
+#include <algorithm>
+
+FilterIndex::FilterIndex() : bucketBitmaps(kBucketCount) {}
+
+int FilterIndex::bucketOf(int popularity) {
+    if (popularity <= 0) return 0;
+    return 32 - __builtin_clz(static_cast<unsigned>(popularity)); // 1 -> 1, 2~3 -> 2, 4~7 -> 3 ...
+}
+
+long long FilterIndex::bucketLow(int bucket) {
+    return bucket == 0 ? static_cast<long long>(INT_MIN) : 1LL << (bucket - 1);
+}
+
+long long FilterIndex::bucketHigh(int bucket) {
+    return bucket == 0 ? 0LL : (1LL << bucket) - 1;
+}
+
+void FilterIndex::clear() {
+    slotById.clear();
+    idBySlot.clear();
+    popularityBySlot.clear();
+    typeBySlot.clear();
+    freeSlots.clear();
+    typeBitmaps.clear();
+    bucketBitmaps.assign(kBucketCount, CompressedBitmap());
+    liveSlots.clear();
+}
+
+void FilterIndex::add(int id, TypeId type, int popularity) {
+    auto it = slotById.find(id);
+    if (it != slotById.end()) {
+        std::uint32_t slot = it->second;
+        if (typeBySlot[slot] != type) {
+            auto typeIt = typeBitmaps.find(typeBySlot[slot]);
+            typeIt->second.remove(slot);
+            if (typeIt->second.empty()) typeBitmaps.erase(typeIt);
+            typeBySlot[slot] = type;
+            typeBitmaps[type].add(slot);
+        }
+        int oldBucket = bucketOf(popularityBySlot[slot]);
+        int newBucket = bucketOf(popularity);
+        if (oldBucket != newBucket) {
+            bucketBitmaps[oldBucket].remove(slot);
+            bucketBitmaps[newBucket].add(slot);
+        }
+        popularityBySlot[slot] = popularity;
+        return;
+    }
+    std::uint32_t slot;
+    if (!freeSlots.empty()) {
+        // 优先复用空出的槽位，位图保持紧凑
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        idBySlot[slot] = id;
+        popularityBySlot[slot] = popularity;
+        typeBySlot[slot] = type;
+    } else {
+        slot = static_cast<std::uint32_t>(idBySlot.size());
+        idBySlot.push_back(id);
+        popularityBySlot.push_back(popularity);
+        typeBySlot.push_back(type);
+    }
+    slotById.emplace(id, slot);
+    typeBitmaps[type].add(slot);
+    bucketBitmaps[bucketOf(popularity)].add(slot);
+    liveSlots.add(slot);
+}
+
+void FilterIndex::remove(int id) {
+    auto it = slotById.find(id);
+    if (it == slotById.end()) return;
+    std::uint32_t slot = it->second;
+    auto typeIt = typeBitmaps.find(typeBySlot[slot]);
+    typeIt->second.remove(slot);
+    if (typeIt->second.empty()) typeBitmaps.erase(typeIt);
+    bucketBitmaps[bucketOf(popularityBySlot[slot])].remove(slot);
+    liveSlots.remove(slot);
+    freeSlots.push_back(slot);
+    slotById.erase(it);
+}
+
+std::size_t FilterIndex::size() const {
+    return slotById.size();
+}
+
+std::vector<int> FilterIndex::filter(const TypeId* type, int minPopularity, int maxPopularity,
+                                     const std::vector<int>* candidates) const {
+    std::vector<int> ids;
+    if (minPopularity > maxPopularity) return ids;
+
+    std::vector<CompressedBitmap> owned;
+    std::vector<const CompressedBitmap*> parts;
+    if (type) {
+        auto it = typeBitmaps.find(*type);
+        if (it == typeBitmaps.end()) return ids;
+        parts.push_back(&it->second);
+    }
+    if (candidates) {
+        std::vector<std::uint32_t> slots;
+        slots.reserve(candidates->size());
+        for (int id : *candidates) {
+            auto it = slotById.find(id);
+            if (it != slotById.end()) slots.push_back(it->second);
+        }
+        std::sort(slots.begin(), slots.end());
+        owned.push_back(CompressedBitmap::fromSorted(slots));
+    }
+    bool verifyPopularity = false;
+    if (minPopularity != INT_MIN || maxPopularity != INT_MAX) {
+        int first = bucketOf(minPopularity);
+        int last = bucketOf(maxPopularity);
+        std::size_t rangeSize = 0;
+        for (int b = first; b <= last; ++b) {
+            rangeSize += bucketBitmaps[b].cardinality();
+        }
+        std::size_t smallest = SIZE_MAX;
+        for (const auto* part : parts) {
+            smallest = std::min(smallest, part->cardinality());
+        }
+        for (const auto& bitmap : owned) {
+            smallest = std::min(smallest, bitmap.cardinality());
+        }
+        if (smallest <= rangeSize) {
+            // 其他条件已经足够有选择性：合并档位位图反而更慢，直接逐个核对人气
+            verifyPopularity = true;
+        } else {
+            CompressedBitmap range;
+            for (int b = first; b <= last; ++b) {
+                if (bucketLow(b) < minPopularity || bucketHigh(b) > maxPopularity) verifyPopularity = true;
+                range |= bucketBitmaps[b];
+            }
+            owned.push_back(std::move(range));
+        }
+    }
+    for (const auto& bitmap : owned) {
+        parts.push_back(&bitmap);
+    }
+    if (parts.empty()) parts.push_back(&liveSlots);
+
+    // 从最小的集合开始求交集，结果为空时立即结束
+    std::sort(parts.begin(), parts.end(), [](const CompressedBitmap* a, const CompressedBitmap* b) {
+        return a->cardinality() < b->cardinality();
+    });
+    CompressedBitmap result = *parts.front();
+    for (std::size_t i = 1; i < parts.size() && !result.empty(); ++i) {
+        result &= *parts[i];
+    }
+
+    ids.reserve(result.cardinality());
+    result.forEach([&](std::uint32_t slot) {
+        int popularity = popularityBySlot[slot];
+        if (verifyPopularity && (popularity < minPopularity || popularity > maxPopularity)) return;
+        ids.push_back(idBySlot[slot]);
+    });
+    return ids;
+}
@@ -0,0 +1,233 @@
+#include "FullTextIndex.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace {
+constexpr double kK1 = 1.2;
+constexpr double kB = 0.75;
+constexpr float kNameWeight = 3.0f;
+constexpr float kTypeWeight = 2.0f;
+constexpr float kDescriptionWeight = 1.0f;
+constexpr double kPopularityWeight = 0.1;
+
+double termScore(double idf, double weight, double length, double averageLength) {
+    return idf * weight * (kK1 + 1.0) / (weight + kK1 * (1.0 - kB + kB * length / averageLength));
+}
+} // namespace
+
+double FullTextIndex::popularityBoost(int popularity) {
+    return 1.0 + kPopularityWeight * std::log1p(static_cast<double>(std::max(popularity, 0)));
+}
+
+std::uint32_t FullTextIndex::termId(const std::string& token) {
+    auto it = termIds.find(token);
+    if (it != termIds.end()) return it->second;
+    std::uint32_t id;
+    if (!freeTermIds.empty()) {
+        id = freeTermIds.back();
+        freeTermIds.pop_back();
+    } else {
+        id = static_cast<std::uint32_t>(terms.size());
+        terms.emplace_back();
+    }
+    terms[id].text = token;
+    termIds.emplace(token, id);
+    return id;
+}
+
+void FullTextIndex::clear() {
+    termIds.clear();
+    terms.clear();
+    freeTermIds.clear();
+    documents.clear();
+    totalLength = 0.0;
+    maxPopularity = 0;
+}
+
+void FullTextIndex::add(int id, std::string_view name, std::string_view type, std::string_view description,
+                        int popularity) {
+    maxPopularity = std::max(maxPopularity, popularity);
+    remove(id);
+
+    std::unordered_map<std::uint32_t, float> weights;
+    std::vector<std::string> tokens;
+    auto addField = [&](std::string_view text, float fieldWeight) {
+        tokens.clear();
+        tokenizeText(text, tokens);
+        for (const auto& token : tokens) {
+            weights[termId(token)] += fieldWeight;
+        }
+    };
+    addField(name, kNameWeight);
+    addField(type, kTypeWeight);
+    addField(description, kDescriptionWeight);
+
+    Document doc;
+    doc.popularity = popularity;
+    doc.terms.assign(weights.begin(), weights.end());
+    for (const auto& entry : doc.terms) {
+        doc.length += entry.second;
+    }
+    for (const auto& entry : doc.terms) {
+        Term& term = terms[entry.first];
+        auto pos = std::lower_bound(term.postings.begin(), term.postings.end(), id,
+                                    [](const Posting& p, int key) { return p.id < key; });
+        term.postings.insert(pos, Posting{id, entry.second});
+        term.maxWeight = std::max(term.maxWeight, entry.second);
+        term.minLength = term.postings.size() == 1 ? doc.length : std::min(term.minLength, doc.length);
+    }
+    totalLength += doc.length;
+    documents.emplace(id, std::move(doc));
+}
+
+void FullTextIndex::remove(int id) {
+    auto it = documents.find(id);
+    if (it == documents.end()) return;
+    for (const auto& entry : it->second.terms) {
+        Term& term = terms[entry.first];
+        auto& postings = term.postings;
+        auto pos = std::lower_bound(postings.begin(), postings.end(), id,
+                                    [](const Posting& p, int key) { return p.id < key; });
+        if (pos != postings.end() && pos->id == id) {
+            postings.erase(pos);
+        }
+        if (postings.empty()) {
+            // 最后一个文档也不再包含该词：删掉词项并回收编号，上界随之重置
+            termIds.erase(term.text);
+            term = Term{};
+            freeTermIds.push_back(entry.first);
+        }
+    }
+    totalLength -= it->second.length;
+    documents.erase(it);
+}
+
+bool FullTextIndex::setPopularity(int id, int popularity) {
+    auto it = documents.find(id);
+    if (it == documents.end()) return false;
+    it->second.popularity = popularity;
+    maxPopularity = std::max(maxPopularity, popularity);
+    return true;
+}
+
+std::size_t FullTextIndex::size() const {
+    return documents.size();
+}
+
+std::vector<FullTextIndex::Hit> FullTextIndex::search(std::string_view query, std::size_t k) const {
+    std::vector<Hit> hits;
+    if (k == 0 || documents.empty()) return hits;
+
+    std::vector<std::string> tokens;
+    tokenizeText(query, tokens);
+    std::sort(tokens.begin(), tokens.end());
+    tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+    const double docCount = static_cast<double>(documents.size());
+    const double averageLength = std::max(totalLength / docCount, 1e-9);
+    struct Cursor {
+        const std::vector<Posting>* postings;
+        std::size_t pos;
+        double idf;
+        double bound;
+    };
+    std::vector<Cursor> cursors;
+    for (const auto& token : tokens) {
+        auto it = termIds.find(token);
+        if (it == termIds.end()) continue;
+        const Term& term = terms[it->second];
+        if (term.postings.empty()) continue;
+        double df = static_cast<double>(term.postings.size());
+        double idf = std::log(1.0 + (docCount - df + 0.5) / (df + 0.5));
+        // 略微放大上界，避免浮点舍入导致误剪枝
+        double bound = termScore(idf, term.maxWeight, term.minLength, averageLength) * (1.0 + 1e-9);
+        cursors.push_back({&term.postings, 0, idf, bound});
+    }
+    if (cursors.empty()) return hits;
+
+    std::sort(cursors.begin(), cursors.end(), [](const Cursor& a, const Cursor& b) { return a.bound < b.bound; });
+    std::vector<double> boundPrefix(cursors.size());
+    double running = 0.0;
+    for (std::size_t i = 0; i < cursors.size(); ++i) {
+        running += cursors[i].bound;
+        boundPrefix[i] = running;
+    }
+    const double maxBoost = popularityBoost(maxPopularity);
+
+    // better(a, b) 表示 a 排在 b 前面；堆顶因此是当前第 k 名
+    auto better = [](const Hit& a, const Hit& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.id < b.id;
+    };
+    std::priority_queue<Hit, std::vector<Hit>, decltype(better)> best(better);
+    auto threshold = [&]() {
+        return best.size() < k ? -std::numeric_limits<double>::infinity() : best.top().score;
+    };
+
+    std::size_t firstEssential = 0;
+    while (true) {
+        // 上界之和达不到门槛的词项单独不可能让文档进入前 k 名
+        while (firstEssential < cursors.size() && boundPrefix[firstEssential] * maxBoost < threshold()) {
+            ++firstEssential;
+        }
+        if (firstEssential == cursors.size()) break;
+
+        int doc = std::numeric_limits<int>::max();
+        bool any = false;
+        for (std::size_t i = firstEssential; i < cursors.size(); ++i) {
+            const Cursor& c = cursors[i];
+            if (c.pos < c.postings->size()) {
+                doc = std::min(doc, (*c.postings)[c.pos].id);
+                any = true;
+            }
+        }
+        if (!any) break;
+
+        const Document& document = documents.at(doc);
+        double score = 0.0;
+        for (std::size_t i = firstEssential; i < cursors.size(); ++i) {
+            Cursor& c = cursors[i];
+            if (c.pos < c.postings->size() && (*c.postings)[c.pos].id == doc) {
+                score += termScore(c.idf, (*c.postings)[c.pos].weight, document.length, averageLength);
+                ++c.pos;
+            }
+        }
+        double boost = popularityBoost(document.popularity);
+        bool pruned = false;
+        for (std::size_t i = firstEssential; i-- > 0;) {
+            if ((score + boundPrefix[i]) * boost < threshold()) {
+                pruned = true;
+                break;
+            }
+            Cursor& c = cursors[i];
+            auto begin = c.postings->begin() + static_cast<std::ptrdiff_t>(c.pos);
+            auto found = std::lower_bound(begin, c.postings->end(), doc,
+                                          [](const Posting& p, int key) { return p.id < key; });
+            c.pos = static_cast<std::size_t>(found - c.postings->begin());
+            if (found != c.postings->end() && found->id == doc) {
+                score += termScore(c.idf, found->weight, document.length, averageLength);
+            }
+        }
+        if (pruned) continue;
+
+        Hit hit{doc, score * boost};
+        if (best.size() < k) {
+            best.push(hit);
+        } else if (better(hit, best.top())) {
+            best.pop();
+            best.push(hit);
+        }
+    }
+
+    hits.reserve(best.size());
+    while (!best.empty()) {
+        hits.push_back(best.top());
+        best.pop();
+    }
+    std::reverse(hits.begin(), hits.end());
+    return hits;
+}
@@ -0,0 +1,50 @@
+#include "LocationColumns.h"
+
+void LocationColumns::clear() {
+    ids.clear();
+    popularity.clear();
+    typeIds.clear();
+}
+
+void LocationColumns::reserve(std::size_t rows) {
+    ids.reserve(rows);
+    popularity.reserve(rows);
+    typeIds.reserve(rows);
+}
+
+void LocationColumns::append(int id, int popularityValue, TypeId typeId) {
+    ids.push_back(id);
+    popularity.push_back(popularityValue);
+    typeIds.push_back(typeId);
+}
+
+void LocationColumns::setPopularity(std::size_t row, int value) {
+    popularity[row] = value;
+}
+
+void LocationColumns::setType(std::size_t row, TypeId typeId) {
+    typeIds[row] = typeId;
+}
+
+void LocationColumns::erase(std::size_t row) {
+    auto offset = static_cast<std::ptrdiff_t>(row);
+    ids.erase(ids.begin() + offset);
+    popularity.erase(popularity.begin() + offset);
+    typeIds.erase(typeIds.begin() + offset);
+}
+
+std::size_t LocationColumns::size() const {
+    return ids.size();
+}
+
+const std::vector<int>& LocationColumns::idColumn() const {
+    return ids;
+}
+
+const std::vector<int>& LocationColumns::popularityColumn() const {
+    return popularity;
+}
+
+const std::vector<TypeId>& LocationColumns::typeColumn() const {
+    return typeIds;
+}
@@ -1,7 +1,12 @@
 #include "LocationManager.h"
+#include "LocationColumns.h"
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <sstream>
+#include <unordered_map>
 
 static std::vector<std::string> split(const std::string& s, char delim) {
     std::vector<std::string> res;
@@ -13,20 +18,131 @@ static std::vector<std::string> split(const std::string& s, char delim) {
     return res;
 }
 
-LocationManager::LocationManager(const std::string& file) : filename(file) {
+Location LocationView::toLocation() const {
+    return Location{ id, std::string(name), std::string(type), std::string(description), popularity };
+}
+
+LocationManager::LocationManager(const std::string& file)
+    : current(std::make_shared<const LocationSnapshot>()), filename(file) {
     loadFromFile();
 }
 
+LocationManager::~LocationManager() {
+    // 已发布但未写回文件的人气在这里落盘，避免退出时丢失
+    try {
+        flushVisits();
+    } catch (const std::exception& ex) {
+        std::cerr << "写回访问计数时出现异常：" << ex.what() << "\n";
+    }
+}
+
+std::shared_ptr<LocationSnapshot> LocationManager::beginWrite() const {
+    return std::make_shared<LocationSnapshot>(*snapshot());
+}
+
+void LocationManager::publish(std::shared_ptr<LocationSnapshot> next, const std::vector<int>& changedIds,
+                              bool popularityOnly, bool reload) {
+    std::uint64_t generation = snapshot()->generation() + 1;
+    auto now = std::chrono::steady_clock::now();
+    next->generationNumber = generation;
+    next->publishTime = now;
+    {
+        std::lock_guard<std::mutex> lock(journalMutex);
+        if (reload) {
+            // 必须在新快照可见之前截断日志：否则派生索引可能在这段间隙里取到新快照、
+            // 却从旧日志查到“没有变更”，把重载前的数据当成已同步
+            journal.clear();
+            journalStart = generation;
+        }
+        for (int id : changedIds) {
+            journal.push_back(JournalEntry{ generation, id, popularityOnly, now });
+        }
+        while (journal.size() > kJournalCapacity) {
+            journalStart = std::max(journalStart, journal.front().generation);
+            journal.pop_front();
+        }
+    }
+    std::atomic_store(&current, std::shared_ptr<const LocationSnapshot>(std::move(next)));
+}
+
+bool LocationManager::changesSince(std::uint64_t since, std::vector<int>& ids) const {
+    std::lock_guard<std::mutex> lock(journalMutex);
+    if (since < journalStart) return false;
+    auto it = std::upper_bound(journal.begin(), journal.end(), since,
+                               [](std::uint64_t value, const JournalEntry& entry) {
+                                   return value < entry.generation;
+                               });
+    for (; it != journal.end(); ++it) {
+        ids.push_back(it->id);
+    }
+    return true;
+}
+
+bool LocationManager::changesSince(std::uint64_t since, std::vector<int>& contentIds,
+                                   std::vector<int>& popularityIds) const {
+    {
+        std::lock_guard<std::mutex> lock(journalMutex);
+        if (since < journalStart) return false;
+        auto it = std::upper_bound(journal.begin(), journal.end(), since,
+                                   [](std::uint64_t value, const JournalEntry& entry) {
+                                       return value < entry.generation;
+                                   });
+        for (; it != journal.end(); ++it) {
+            (it->popularityOnly ? popularityIds : contentIds).push_back(it->id);
+        }
+    }
+    std::sort(contentIds.begin(), contentIds.end());
+    contentIds.erase(std::unique(contentIds.begin(), contentIds.end()), contentIds.end());
+    std::sort(popularityIds.begin(), popularityIds.end());
+    popularityIds.erase(std::unique(popularityIds.begin(), popularityIds.end()), popularityIds.end());
+    // 同一地点既有内容变更又有人气变更时按内容变更处理
+    popularityIds.erase(std::remove_if(popularityIds.begin(), popularityIds.end(),
+                                       [&](int id) {
+                                           return std::binary_search(contentIds.begin(), contentIds.end(), id);
+                                       }),
+                        popularityIds.end());
+    return true;
+}
+
+bool LocationManager::changesSince(std::uint64_t since, std::vector<Change>& changes) const {
+    std::lock_guard<std::mutex> lock(journalMutex);
+    if (since < journalStart) return false;
+    auto it = std::upper_bound(journal.begin(), journal.end(), since,
+                               [](std::uint64_t value, const JournalEntry& entry) {
+                                   return value < entry.generation;
+                               });
+    for (; it != journal.end(); ++it) {
+        changes.push_back(Change{ it->id, it->publishedAt });
+    }
+    return true;
+}
+
+std::shared_ptr<const LocationSnapshot> LocationManager::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+std::uint64_t LocationManager::generation() const {
+    return snapshot()->generation();
+}
+
 void LocationManager::loadFromFile() {
-    locations.clear();
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = std::make_shared<LocationSnapshot>();
+    next->setColumnar(columnarEnabled);
     std::ifstream fin(filename, std::ios::binary);
     if (!fin.is_open()) {
         std::cout << "提示：未找到数据文件 '" << filename << "'，将创建新文件（首次保存时）。\n";
+        publish(std::move(next), {}, false, true);
+        popularityUnsaved = false;
         return;
     }
 
+    const bool lazy = lazyDescriptions.load();
     std::string line;
+    std::uint64_t lineOffset = 0;
     while (std::getline(fin, line)) {
+        std::uint64_t lineStart = lineOffset;
+        lineOffset += line.size() + 1;
         // 去掉 Windows 回车
         if (!line.empty() && line.back() == '\r') line.pop_back();
         if (line.empty()) continue;
@@ -51,8 +167,23 @@ void LocationManager::loadFromFile() {
                 try { popularity = std::stoi(parts[4]); }
                 catch (...) { popularity = 0; }
             }
-            Location loc{ id, name, type, desc, popularity };
-            locations.push_back(loc);
+            Location loc{ id, name, type, std::string(), popularity };
+            if (!lazy) {
+                loc.description = std::move(desc);
+            }
+            if (!next->append(loc)) {
+                std::cerr << "警告：ID 重复，跳过 -> " << line << "\n";
+                continue;
+            }
+            if (lazy) {
+                // 描述是第 4 个字段，偏移量从原始行（含 BOM）计算
+                std::size_t start = 0;
+                for (int field = 0; field < 3; ++field) {
+                    start = line.find('|', start) + 1;
+                }
+                next->detachDescription(next->size() - 1, lineStart + start,
+                                        static_cast<std::uint32_t>(desc.size()));
+            }
         }
         catch (...) {
             std::cerr << "警告：解析行失败，跳过 -> " << line << "\n";
@@ -61,77 +192,378 @@ void LocationManager::loadFromFile() {
     }
 
     fin.close();
+    std::unique_lock<std::shared_mutex> fileLock(fileMutex);
+    publish(std::move(next), {}, false, true);
+    popularityUnsaved = false;
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    descriptionCache.clear();
 }
 
 void LocationManager::saveToFile() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    applyVisits();
+    persist();
+}
+
+// 把当前版本写回数据文件，调用方需持有 writeMutex
+void LocationManager::persist() {
+    if (lazyDescriptions) {
+        commit(beginWrite());
+    } else if (writeFile()) {
+        popularityUnsaved = false;
+    }
+}
+
+// 发布新版本并写回数据文件，调用方需持有 writeMutex。
+// 延迟加载模式下先写临时文件并算出新的描述偏移量，再在独占文件锁下替换文件并发布，
+// 保证任何时刻读到的偏移量都与磁盘上的文件对应。
+void LocationManager::commit(std::shared_ptr<LocationSnapshot> next, const std::vector<int>& changedIds,
+                             bool popularityOnly) {
+    if (!lazyDescriptions) {
+        publish(std::move(next), changedIds, popularityOnly);
+        if (writeFile()) {
+            popularityUnsaved = false;
+        }
+        return;
+    }
+
+    std::string tmpFile = filename + ".tmp";
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> offsets;
+    if (!writeDetached(*next, tmpFile, offsets)) {
+        // 旧文件没有变动，快照中已有的偏移量仍然有效，新描述保留在内存中
+        publish(std::move(next), changedIds, popularityOnly);
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> fileLock(fileMutex);
+    std::error_code ec;
+    std::filesystem::rename(tmpFile, filename, ec);
+    if (ec) {
+        std::cerr << "错误：无法替换数据文件 '" << filename << "'：" << ec.message() << "\n";
+        std::filesystem::remove(tmpFile, ec);
+        publish(std::move(next), changedIds, popularityOnly);
+        return;
+    }
+    for (std::size_t row = 0; row < offsets.size(); ++row) {
+        next->detachDescription(row, offsets[row].first, offsets[row].second);
+    }
+    publish(std::move(next), changedIds, popularityOnly);
+    popularityUnsaved = false;
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    descriptionCache.clear();
+}
+
+bool LocationManager::writeDetached(const LocationSnapshot& next, const std::string& path,
+                                    std::vector<std::pair<std::uint64_t, std::uint32_t>>& offsets) const {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    if (!fout.is_open()) {
+        std::cerr << "错误：无法写入文件 '" << path << "'\n";
+        return false;
+    }
+    std::ifstream fin(filename, std::ios::binary);
+    offsets.clear();
+    offsets.reserve(next.size());
+    std::uint64_t offset = 0;
+    for (std::size_t row = 0; row < next.size(); ++row) {
+        const auto& rec = next.recordAt(row);
+        std::string desc = readDescription(next, row, fin);
+        std::string head = std::to_string(rec.id) + "|" + rec.name + "|" + next.typeDictionary().name(rec.typeId) + "|";
+        std::string tail = "|" + std::to_string(next.popularityAt(row)) + "\n";
+        fout << head << desc << tail;
+        offsets.emplace_back(offset + head.size(), static_cast<std::uint32_t>(desc.size()));
+        offset += head.size() + desc.size() + tail.size();
+    }
+    fout.close();
+    return !fout.fail();
+}
+
+std::string LocationManager::readDescription(const LocationSnapshot& snap, std::size_t row, std::ifstream& fin) const {
+    const auto& rec = snap.recordAt(row);
+    if (!rec.descriptionOnDisk) {
+        return rec.description;
+    }
+    std::string text(rec.descriptionLength, '\0');
+    fin.clear();
+    fin.seekg(static_cast<std::streamoff>(rec.descriptionOffset));
+    if (!fin.read(&text[0], static_cast<std::streamsize>(text.size()))) {
+        return std::string();
+    }
+    return text;
+}
+
+bool LocationManager::writeFile() {
     std::ofstream fout(filename, std::ios::trunc);
     if (!fout.is_open()) {
         std::cerr << "错误：无法写入文件 '" << filename << "'\n";
-        return;
+        return false;
     }
-    for (const auto& l : locations) {
+    snapshot()->forEachLocation([&fout](const LocationView& l) {
         fout << l.id << "|" << l.name << "|" << l.type << "|" << l.description << "|" << l.popularity << "\n";
-    }
+    });
     fout.close();
+    return !fout.fail();
 }
 
 void LocationManager::addLocation(const Location& loc) {
-    for (const auto& l : locations) {
-        if (l.id == loc.id) {
-            std::cout << "添加失败：ID " << loc.id << " 已存在！\n";
-            return;
-        }
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = beginWrite();
+    if (!next->append(loc)) {
+        std::cout << "添加失败：ID " << loc.id << " 已存在！\n";
+        return;
     }
-    locations.push_back(loc);
-    saveToFile();
+    commit(std::move(next), { loc.id });
     std::cout << "成功添加地点：" << loc.name << "\n";
 }
 
 void LocationManager::removeLocation(int id) {
-    for (auto it = locations.begin(); it != locations.end(); ++it) {
-        if (it->id == id) {
-            std::cout << "已删除地点：" << it->name << "\n";
-            locations.erase(it);
-            saveToFile();
-            return;
-        }
+    std::lock_guard<std::mutex> lock(writeMutex);
+    LocationView existing{};
+    if (!snapshot()->viewLocation(id, existing)) {
+        std::cout << "删除失败：未找到ID " << id << "\n";
+        return;
     }
-    std::cout << "删除失败：未找到ID " << id << "\n";
+    std::cout << "已删除地点：" << existing.name << "\n";
+    auto next = beginWrite();
+    next->remove(id);
+    commit(std::move(next), { id });
 }
 
 void LocationManager::updateLocation(int id, const Location& newInfo) {
-    for (auto& l : locations) {
-        if (l.id == id) {
-            l.name = newInfo.name;
-            l.type = newInfo.type;
-            l.description = newInfo.description;
-            l.popularity = newInfo.popularity;
-            saveToFile();
-            std::cout << "已更新地点：" << l.name << "\n";
-            return;
-        }
+    std::lock_guard<std::mutex> lock(writeMutex);
+    auto next = beginWrite();
+    if (!next->update(id, newInfo)) {
+        std::cout << "更新失败：未找到ID " << id << "\n";
+        return;
     }
-    std::cout << "更新失败：未找到ID " << id << "\n";
+    commit(std::move(next), { id });
+    std::cout << "已更新地点：" << newInfo.name << "\n";
 }
 
-Location* LocationManager::findLocation(int id) {
-    for (auto& l : locations) {
-        if (l.id == id) return &l;
+bool LocationManager::findLocation(int id, Location& out) const {
+    std::shared_lock<std::shared_mutex> fileLock(fileMutex);
+    auto snap = snapshot();
+    std::size_t row = 0;
+    if (!snap->rowOf(id, row)) return false;
+    out = snap->viewAt(row).toLocation();
+    if (snap->recordAt(row).descriptionOnDisk) {
+        std::ifstream fin(filename, std::ios::binary);
+        out.description = readDescription(*snap, row, fin);
     }
-    return nullptr;
+    return true;
 }
 
 std::vector<Location> LocationManager::getAllLocations() const {
-    return locations;
+    std::shared_lock<std::shared_mutex> fileLock(fileMutex);
+    auto snap = snapshot();
+    // 是否需要读文件以快照中的记录为准，不看可能被并发切换的开关
+    std::ifstream fin;
+    std::vector<Location> all;
+    all.reserve(snap->size());
+    for (std::size_t row = 0; row < snap->size(); ++row) {
+        all.push_back(snap->viewAt(row).toLocation());
+        if (snap->recordAt(row).descriptionOnDisk) {
+            if (!fin.is_open()) fin.open(filename, std::ios::binary);
+            all.back().description = readDescription(*snap, row, fin);
+        }
+    }
+    return all;
+}
+
+std::size_t LocationManager::size() const {
+    return snapshot()->size();
+}
+
+void LocationManager::forEachLocation(const std::function<void(const LocationView&)>& visitor) const {
+    snapshot()->forEachLocation(visitor);
+}
+
+bool LocationManager::viewLocation(int id, LocationView& out) const {
+    return snapshot()->viewLocation(id, out);
+}
+
+std::shared_ptr<const TypeDictionary> LocationManager::typeDictionary() const {
+    auto snap = snapshot();
+    // 别名构造：指向快照内部的字典，但保住整个快照
+    return std::shared_ptr<const TypeDictionary>(snap, &snap->typeDictionary());
+}
+
+std::vector<std::string> LocationManager::listTypes() const {
+    return snapshot()->listTypes();
+}
+
+std::size_t LocationManager::countByType(const std::string& type) const {
+    return snapshot()->countByType(type);
+}
+
+void LocationManager::forEachOfType(const std::string& type,
+                                    const std::function<void(const LocationView&)>& visitor) const {
+    snapshot()->forEachOfType(type, visitor);
+}
+
+void LocationManager::setColumnarLayout(bool enabled) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (enabled == columnarEnabled) return;
+    columnarEnabled = enabled;
+    auto next = beginWrite();
+    next->setColumnar(enabled);
+    publish(std::move(next));
+}
+
+bool LocationManager::columnarLayout() const {
+    return snapshot()->columns() != nullptr;
+}
+
+std::shared_ptr<const LocationColumns> LocationManager::columns() const {
+    auto snap = snapshot();
+    const LocationColumns* columnStore = snap->columns();
+    if (!columnStore) return nullptr;
+    return std::shared_ptr<const LocationColumns>(snap, columnStore);
+}
+
+void LocationManager::recordVisit(int id) {
+    visitCounter.record(id);
+    long long threshold = visitFlushThreshold.load(std::memory_order_relaxed);
+    if (threshold > 0 && visitCounter.pending() >= threshold) {
+        // 只让一个线程负责写回，其余线程继续累加
+        std::unique_lock<std::mutex> lock(writeMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            applyVisits();
+        }
+    }
+}
+
+std::size_t LocationManager::flushVisits() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    std::size_t updated = applyVisits();
+    if (popularityUnsaved) {
+        persist();
+    }
+    return updated;
+}
+
+// 把累计的访问增量发布为新版本，调用方需持有 writeMutex；返回被更新的地点数量。
+// 这里只发布不写文件：新版本与上一版共享名称、描述等冷数据，只复制人气列，
+// 数据文件留到 flushVisits/saveToFile 时再写回
+std::size_t LocationManager::applyVisits() {
+    auto deltas = visitCounter.drain();
+    if (deltas.empty()) return 0;
+    auto next = beginWrite();
+    std::vector<int> changedIds;
+    changedIds.reserve(deltas.size());
+    for (const auto& [id, delta] : deltas) {
+        std::size_t row = 0;
+        if (!next->rowOf(id, row)) continue; // 地点已被删除
+        long long value = static_cast<long long>(next->popularityAt(row)) + delta;
+        value = std::min<long long>(std::max<long long>(value, std::numeric_limits<int>::min()),
+                                    std::numeric_limits<int>::max());
+        next->setPopularity(row, static_cast<int>(value));
+        changedIds.push_back(id);
+    }
+    if (!changedIds.empty()) {
+        publish(std::move(next), changedIds, true);
+        popularityUnsaved = true;
+    }
+    return changedIds.size();
+}
+
+long long LocationManager::pendingVisits() const {
+    return visitCounter.pending();
+}
+
+void LocationManager::setVisitFlushThreshold(long long threshold) {
+    visitFlushThreshold.store(threshold, std::memory_order_relaxed);
+}
+
+void LocationManager::setLazyDescriptions(bool enabled) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (enabled == lazyDescriptions) return;
+    if (enabled) {
+        // 重写一次数据文件，得到每条描述的偏移量后释放内存中的描述
+        lazyDescriptions = true;
+        commit(beginWrite());
+        return;
+    }
+    auto next = beginWrite();
+    {
+        std::ifstream fin(filename, std::ios::binary);
+        for (std::size_t row = 0; row < next->size(); ++row) {
+            if (next->recordAt(row).descriptionOnDisk) {
+                next->attachDescription(row, readDescription(*next, row, fin));
+            }
+        }
+    }
+    lazyDescriptions = false;
+    publish(std::move(next));
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    descriptionCache.clear();
+}
+
+bool LocationManager::lazyDescriptionsEnabled() const {
+    return lazyDescriptions.load();
+}
+
+void LocationManager::setDescriptionCacheCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    descriptionCache.setCapacity(capacity);
+}
+
+std::string LocationManager::description(int id) const {
+    std::shared_lock<std::shared_mutex> fileLock(fileMutex);
+    auto snap = snapshot();
+    std::size_t row = 0;
+    if (!snap->rowOf(id, row)) return std::string();
+    const auto& rec = snap->recordAt(row);
+    if (!rec.descriptionOnDisk) {
+        return rec.description;
+    }
+    std::string text;
+    {
+        std::lock_guard<std::mutex> cacheLock(cacheMutex);
+        if (descriptionCache.get(id, text)) {
+            return text;
+        }
+    }
+    std::ifstream fin(filename, std::ios::binary);
+    text = readDescription(*snap, row, fin);
+    std::lock_guard<std::mutex> cacheLock(cacheMutex);
+    descriptionCache.put(id, text);
+    return text;
+}
+
+std::vector<std::string> LocationManager::descriptions(const std::vector<int>& ids) const {
+    std::shared_lock<std::shared_mutex> fileLock(fileMutex);
+    auto snap = snapshot();
+    std::vector<std::string> texts(ids.size());
+    std::vector<std::pair<std::uint64_t, std::size_t>> onDisk; // (文件偏移, 结果下标)
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+        std::size_t row = 0;
+        if (!snap->rowOf(ids[i], row)) continue;
+        const auto& rec = snap->recordAt(row);
+        if (rec.descriptionOnDisk) {
+            onDisk.emplace_back(rec.descriptionOffset, i);
+        } else {
+            texts[i] = rec.description;
+        }
+    }
+    if (onDisk.empty()) return texts;
+    std::sort(onDisk.begin(), onDisk.end());
+    std::ifstream fin(filename, std::ios::binary);
+    for (const auto& entry : onDisk) {
+        std::size_t row = 0;
+        snap->rowOf(ids[entry.second], row);
+        texts[entry.second] = readDescription(*snap, row, fin);
+    }
+    return texts;
 }
 
 void LocationManager::listAll() {
-    if (locations.empty()) {
+    auto all = getAllLocations();
+    if (all.empty()) {
         std::cout << "当前没有任何地点信息。\n";
         return;
     }
     std::cout << "===== 校园地点数据库 =====\n";
-    for (const auto& l : locations) {
+    for (const auto& l : all) {
         std::cout << "ID: " << l.id
             << " | 名称: " << l.name
             << " | 类型: " << l.type
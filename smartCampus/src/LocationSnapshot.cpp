@@ -0,0 +1,219 @@
+#include "LocationSnapshot.h"
+
+LocationSnapshot::LocationSnapshot()
+    : table(std::make_shared<Table>()) {}
+
+LocationSnapshot::LocationSnapshot(const LocationSnapshot& other)
+    : table(other.table),
+      ownsTable(false),
+      popularity(other.popularity),
+      generationNumber(other.generationNumber),
+      publishTime(other.publishTime) {
+    if (other.columnStore) {
+        columnStore = std::make_unique<LocationColumns>(*other.columnStore);
+    }
+}
+
+LocationSnapshot::Table& LocationSnapshot::editTable() {
+    if (!ownsTable) {
+        // 已发布的版本可能仍在共享这份冷数据，改动前复制一份
+        table = std::make_shared<Table>(*table);
+        ownsTable = true;
+    }
+    return *table;
+}
+
+const LocationSnapshot::Record& LocationSnapshot::recordAt(std::size_t row) const {
+    return table->records[row];
+}
+
+LocationSnapshot::Record LocationSnapshot::makeRecord(Table& data, const Location& loc) {
+    TypeId typeId = data.types.intern(loc.type);
+    if (typeId >= data.typeCounts.size()) {
+        data.typeCounts.resize(typeId + 1, 0);
+    }
+    return Record{ loc.id, loc.name, typeId, loc.description };
+}
+
+bool LocationSnapshot::append(const Location& loc) {
+    if (table->rowById.count(loc.id)) return false;
+    Table& data = editTable();
+    data.records.push_back(makeRecord(data, loc));
+    const Record& rec = data.records.back();
+    ++data.typeCounts[rec.typeId];
+    data.rowById.emplace(loc.id, data.records.size() - 1);
+    popularity.push_back(loc.popularity);
+    if (columnStore) {
+        columnStore->append(rec.id, loc.popularity, rec.typeId);
+    }
+    return true;
+}
+
+bool LocationSnapshot::remove(int id) {
+    auto found = table->rowById.find(id);
+    if (found == table->rowById.end()) return false;
+    std::size_t row = found->second;
+    Table& data = editTable();
+    --data.typeCounts[data.records[row].typeId];
+    data.records.erase(data.records.begin() + static_cast<std::ptrdiff_t>(row));
+    data.rowById.erase(id);
+    // 只有被删行之后的记录行号前移一位
+    for (std::size_t later = row; later < data.records.size(); ++later) {
+        data.rowById[data.records[later].id] = later;
+    }
+    popularity.erase(popularity.begin() + static_cast<std::ptrdiff_t>(row));
+    if (columnStore) {
+        columnStore->erase(row);
+    }
+    return true;
+}
+
+bool LocationSnapshot::update(int id, const Location& newInfo) {
+    auto found = table->rowById.find(id);
+    if (found == table->rowById.end()) return false;
+    std::size_t row = found->second;
+    Table& data = editTable();
+    Record& rec = data.records[row];
+    Record updated = makeRecord(data, newInfo);
+    --data.typeCounts[rec.typeId];
+    ++data.typeCounts[updated.typeId];
+    rec.name = newInfo.name;
+    rec.typeId = updated.typeId;
+    attachDescription(row, newInfo.description);
+    popularity[row] = newInfo.popularity;
+    if (columnStore) {
+        columnStore->setType(row, rec.typeId);
+        columnStore->setPopularity(row, newInfo.popularity);
+    }
+    return true;
+}
+
+void LocationSnapshot::setPopularity(std::size_t row, int value) {
+    popularity[row] = value;
+    if (columnStore) {
+        columnStore->setPopularity(row, value);
+    }
+}
+
+void LocationSnapshot::detachDescription(std::size_t row, std::uint64_t offset, std::uint32_t length) {
+    Record& rec = editTable().records[row];
+    std::string().swap(rec.description);
+    rec.descriptionOffset = offset;
+    rec.descriptionLength = length;
+    rec.descriptionOnDisk = true;
+}
+
+void LocationSnapshot::attachDescription(std::size_t row, std::string text) {
+    Record& rec = editTable().records[row];
+    rec.description = std::move(text);
+    rec.descriptionOffset = 0;
+    rec.descriptionLength = 0;
+    rec.descriptionOnDisk = false;
+}
+
+void LocationSnapshot::setColumnar(bool enabled) {
+    if (enabled == (columnStore != nullptr)) return;
+    if (enabled) {
+        columnStore = std::make_unique<LocationColumns>();
+        columnStore->reserve(table->records.size());
+        for (std::size_t row = 0; row < table->records.size(); ++row) {
+            const Record& rec = table->records[row];
+            columnStore->append(rec.id, popularity[row], rec.typeId);
+        }
+    } else {
+        columnStore.reset();
+    }
+}
+
+std::uint64_t LocationSnapshot::generation() const {
+    return generationNumber;
+}
+
+std::chrono::steady_clock::time_point LocationSnapshot::publishedAt() const {
+    return publishTime;
+}
+
+std::size_t LocationSnapshot::size() const {
+    return table->records.size();
+}
+
+LocationView LocationSnapshot::viewAt(std::size_t row) const {
+    const Record& rec = table->records[row];
+    return LocationView{ rec.id, rec.name, table->types.name(rec.typeId), rec.description, popularity[row], rec.typeId };
+}
+
+int LocationSnapshot::idAt(std::size_t row) const {
+    return table->records[row].id;
+}
+
+int LocationSnapshot::popularityAt(std::size_t row) const {
+    return popularity[row];
+}
+
+TypeId LocationSnapshot::typeAt(std::size_t row) const {
+    return table->records[row].typeId;
+}
+
+bool LocationSnapshot::viewLocation(int id, LocationView& out) const {
+    auto it = table->rowById.find(id);
+    if (it == table->rowById.end()) return false;
+    out = viewAt(it->second);
+    return true;
+}
+
+bool LocationSnapshot::rowOf(int id, std::size_t& row) const {
+    auto it = table->rowById.find(id);
+    if (it == table->rowById.end()) return false;
+    row = it->second;
+    return true;
+}
+
+void LocationSnapshot::forEachLocation(const std::function<void(const LocationView&)>& visitor) const {
+    for (std::size_t row = 0; row < table->records.size(); ++row) {
+        visitor(viewAt(row));
+    }
+}
+
+const TypeDictionary& LocationSnapshot::typeDictionary() const {
+    return table->types;
+}
+
+std::vector<std::string> LocationSnapshot::listTypes() const {
+    std::vector<std::string> result;
+    for (TypeId id = 0; id < table->typeCounts.size(); ++id) {
+        if (table->typeCounts[id] > 0) {
+            result.push_back(table->types.name(id));
+        }
+    }
+    return result;
+}
+
+std::size_t LocationSnapshot::countByType(const std::string& type) const {
+    TypeId typeId = table->types.find(type);
+    if (typeId == TypeDictionary::kInvalidType || typeId >= table->typeCounts.size()) return 0;
+    return table->typeCounts[typeId];
+}
+
+void LocationSnapshot::forEachOfType(const std::string& type,
+                                     const std::function<void(const LocationView&)>& visitor) const {
+    TypeId typeId = table->types.find(type);
+    if (typeId == TypeDictionary::kInvalidType) return;
+    if (columnStore) {
+        const auto& typeColumn = columnStore->typeColumn();
+        for (std::size_t row = 0; row < typeColumn.size(); ++row) {
+            if (typeColumn[row] == typeId) {
+                visitor(viewAt(row));
+            }
+        }
+        return;
+    }
+    for (std::size_t row = 0; row < table->records.size(); ++row) {
+        if (table->records[row].typeId == typeId) {
+            visitor(viewAt(row));
+        }
+    }
+}
+
+const LocationColumns* LocationSnapshot::columns() const {
+    return columnStore.get();
+}
@@ -6,7 +6,9 @@
 #include <queue>
 
 void NavigationGraph::addLocation(const std::string& name) {
-    adjacency.emplace(name, std::vector<std::pair<std::string, double>>());
+    if (adjacency.emplace(name, std::vector<std::pair<std::string, double>>()).second) {
+        ++generationCounter;
+    }
 }
 
 void NavigationGraph::addEdge(const std::string& from, const std::string& to, double distance, bool bidirectional) {
@@ -20,6 +22,7 @@ void NavigationGraph::addEdge(const std::string& from, const std::string& to, do
     if (bidirectional) {
         adjacency[to].emplace_back(from, distance);
     }
+    ++generationCounter;
 }
 
 bool NavigationGraph::hasLocation(const std::string& name) const {
@@ -105,4 +108,9 @@ std::unordered_map<std::string, std::vector<std::pair<std::string, double>>> Nav
 
 void NavigationGraph::clear() {
     adjacency.clear();
+    ++generationCounter;
+}
+
+std::uint64_t NavigationGraph::generation() const {
+    return generationCounter;
 }
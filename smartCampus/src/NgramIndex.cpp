@@ -0,0 +1,151 @@
+#include "NgramIndex.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+constexpr std::uint64_t kUnigramTag = 1ULL << 63;
+
+std::uint64_t unigramKey(char32_t cp) {
+    return kUnigramTag | static_cast<std::uint64_t>(cp);
+}
+
+std::uint64_t bigramKey(char32_t first, char32_t second) {
+    return (static_cast<std::uint64_t>(first) << 21) | static_cast<std::uint64_t>(second);
+}
+} // namespace
+
+std::vector<std::uint64_t> NgramIndex::nameGrams(const std::vector<char32_t>& codepoints) {
+    std::vector<std::uint64_t> grams;
+    grams.reserve(codepoints.size() * 2);
+    for (std::size_t i = 0; i < codepoints.size(); ++i) {
+        grams.push_back(unigramKey(codepoints[i]));
+        if (i + 1 < codepoints.size()) {
+            grams.push_back(bigramKey(codepoints[i], codepoints[i + 1]));
+        }
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+std::vector<std::uint64_t> NgramIndex::queryGrams(const std::vector<char32_t>& codepoints, bool& partial) {
+    // 截断在多字节字符中间的关键字会解出非法码点，这些位置不参与 gram 过滤，只在核对时按字节匹配
+    partial = false;
+    std::vector<std::uint64_t> grams;
+    for (std::size_t i = 0; i < codepoints.size(); ++i) {
+        if (codepoints[i] >= 0x110000) {
+            partial = true;
+            continue;
+        }
+        if (codepoints.size() == 1) {
+            grams.push_back(unigramKey(codepoints[i]));
+        } else if (i + 1 < codepoints.size() && codepoints[i + 1] < 0x110000) {
+            grams.push_back(bigramKey(codepoints[i], codepoints[i + 1]));
+        }
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+void NgramIndex::insertSorted(std::vector<int>& list, int id) {
+    auto it = std::lower_bound(list.begin(), list.end(), id);
+    if (it == list.end() || *it != id) {
+        list.insert(it, id);
+    }
+}
+
+void NgramIndex::eraseSorted(std::vector<int>& list, int id) {
+    auto it = std::lower_bound(list.begin(), list.end(), id);
+    if (it != list.end() && *it == id) {
+        list.erase(it);
+    }
+}
+
+void NgramIndex::clear() {
+    postings.clear();
+    lowerNames.clear();
+}
+
+void NgramIndex::add(int id, std::string_view name) {
+    std::string lowered = asciiLower(name);
+    auto existing = lowerNames.find(id);
+    if (existing != lowerNames.end()) {
+        if (existing->second == lowered) return;
+        remove(id);
+    }
+    for (std::uint64_t gram : nameGrams(decodeUtf8(lowered))) {
+        insertSorted(postings[gram], id);
+    }
+    lowerNames.emplace(id, std::move(lowered));
+}
+
+void NgramIndex::remove(int id) {
+    auto it = lowerNames.find(id);
+    if (it == lowerNames.end()) return;
+    for (std::uint64_t gram : nameGrams(decodeUtf8(it->second))) {
+        auto posting = postings.find(gram);
+        if (posting == postings.end()) continue;
+        eraseSorted(posting->second, id);
+        if (posting->second.empty()) {
+            postings.erase(posting);
+        }
+    }
+    lowerNames.erase(it);
+}
+
+std::size_t NgramIndex::size() const {
+    return lowerNames.size();
+}
+
+std::vector<int> NgramIndex::search(std::string_view keyword) const {
+    std::vector<int> result;
+    if (keyword.empty()) {
+        result.reserve(lowerNames.size());
+        for (const auto& kv : lowerNames) {
+            result.push_back(kv.first);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    std::string lowered = asciiLower(keyword);
+    auto codepoints = decodeUtf8(lowered);
+    bool partial = false;
+    auto grams = queryGrams(codepoints, partial);
+
+    if (grams.empty()) {
+        result = search(std::string_view());
+    } else {
+        std::vector<const std::vector<int>*> lists;
+        lists.reserve(grams.size());
+        for (std::uint64_t gram : grams) {
+            auto it = postings.find(gram);
+            if (it == postings.end()) return result; // 有一个 gram 不存在即无匹配
+            lists.push_back(&it->second);
+        }
+        // 从最短的倒排表开始求交集
+        std::sort(lists.begin(), lists.end(), [](const std::vector<int>* a, const std::vector<int>* b) {
+            return a->size() < b->size();
+        });
+        result = *lists.front();
+        std::vector<int> narrowed;
+        for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+            narrowed.clear();
+            std::set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(),
+                                  std::back_inserter(narrowed));
+            result.swap(narrowed);
+        }
+    }
+
+    if (partial || codepoints.size() > 2) {
+        result.erase(std::remove_if(result.begin(), result.end(),
+                                    [&](int id) {
+                                        return lowerNames.at(id).find(lowered) == std::string::npos;
+                                    }),
+                     result.end());
+    }
+    return result;
+}
@@ -0,0 +1,74 @@
+#include "PinyinInitials.h"
+#include "TextUtils.h"
+
+#include <cstddef>
+#include <vector>
+
+extern const char kPinyinInitialTable[];
+
+namespace {
+constexpr char32_t kTableFirst = 0x4E00;
+constexpr char32_t kTableLast = 0x9FA5;
+constexpr std::size_t kMaxVariants = 8;
+
+// 常见多音字在默认读音之外的首字母
+struct Polyphone {
+    char32_t codepoint;
+    const char* extra;
+};
+
+constexpr Polyphone kPolyphones[] = {
+    {U'行', "h"}, {U'长', "c"}, {U'重', "c"}, {U'乐', "y"}, {U'会', "k"}, {U'厦', "x"},
+    {U'藏', "z"}, {U'朝', "z"}, {U'单', "sc"}, {U'调', "t"}, {U'传', "z"}, {U'解', "x"},
+    {U'曾', "z"}, {U'便', "p"}, {U'省', "x"}, {U'校', "j"}, {U'降', "x"}, {U'率', "s"},
+};
+
+const char* extraInitials(char32_t cp) {
+    for (const auto& p : kPolyphones) {
+        if (p.codepoint == cp) return p.extra;
+    }
+    return nullptr;
+}
+} // namespace
+
+char pinyinInitial(char32_t cp) {
+    if (cp < kTableFirst || cp > kTableLast) return 0;
+    char initial = kPinyinInitialTable[cp - kTableFirst];
+    return initial == '_' ? 0 : initial;
+}
+
+std::string pinyinInitials(std::string_view name) {
+    std::vector<std::string> variants(1);
+    for (char32_t cp : decodeUtf8(name)) {
+        if ((cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z')) {
+            for (auto& v : variants) v.push_back(static_cast<char>(cp));
+            continue;
+        }
+        if (cp >= 'A' && cp <= 'Z') {
+            for (auto& v : variants) v.push_back(static_cast<char>(cp - 'A' + 'a'));
+            continue;
+        }
+        char initial = pinyinInitial(cp);
+        if (initial == 0) continue;
+        const char* extra = extraInitials(cp);
+        std::size_t base = variants.size();
+        if (extra) {
+            // 每个候选再按其他读音复制一份，超过上限后只保留默认读音
+            for (const char* e = extra; *e && variants.size() + base <= kMaxVariants; ++e) {
+                for (std::size_t i = 0; i < base; ++i) {
+                    variants.push_back(variants[i]);
+                    variants.back().push_back(*e);
+                }
+            }
+        }
+        for (std::size_t i = 0; i < base; ++i) {
+            variants[i].push_back(initial);
+        }
+    }
+    std::string joined;
+    for (std::size_t i = 0; i < variants.size(); ++i) {
+        if (i > 0) joined.push_back('|');
+        joined += variants[i];
+    }
+    return joined;
+}
@@ -0,0 +1,54 @@
+#include "PopularityCounter.h"
+
+#include <mutex>
+
+PopularityCounter::PopularityCounter(std::size_t shards)
+    : shards(std::make_unique<Shard[]>(shards == 0 ? 1 : shards)),
+      shardCount(shards == 0 ? 1 : shards) {}
+
+PopularityCounter::Shard& PopularityCounter::shardFor(int id) {
+    std::size_t h = std::hash<int>()(id);
+    // 打散连续 ID，避免集中到少数分片
+    h ^= h >> 16;
+    h *= 0x45d9f3bU;
+    h ^= h >> 16;
+    return shards[h % shardCount];
+}
+
+void PopularityCounter::record(int id, long long delta) {
+    Shard& shard = shardFor(id);
+    {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.counters.find(id);
+        if (it != shard.counters.end()) {
+            it->second.fetch_add(delta, std::memory_order_relaxed);
+            pendingTotal.fetch_add(delta, std::memory_order_relaxed);
+            return;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.counters.try_emplace(id, 0).first->second.fetch_add(delta, std::memory_order_relaxed);
+    pendingTotal.fetch_add(delta, std::memory_order_relaxed);
+}
+
+long long PopularityCounter::pending() const {
+    return pendingTotal.load(std::memory_order_relaxed);
+}
+
+std::vector<std::pair<int, long long>> PopularityCounter::drain() {
+    std::vector<std::pair<int, long long>> deltas;
+    long long drained = 0;
+    for (std::size_t i = 0; i < shardCount; ++i) {
+        std::unique_lock<std::shared_mutex> lock(shards[i].mutex);
+        for (auto& kv : shards[i].counters) {
+            long long value = kv.second.load(std::memory_order_relaxed);
+            if (value != 0) {
+                deltas.emplace_back(kv.first, value);
+                drained += value;
+            }
+        }
+        shards[i].counters.clear();
+    }
+    pendingTotal.fetch_sub(drained, std::memory_order_relaxed);
+    return deltas;
+}
@@ -0,0 +1,61 @@
+#include "PopularityLeaderboard.h"
+
+void PopularityLeaderboard::clear() {
+    ordered.clear();
+    popularityById.clear();
+}
+
+void PopularityLeaderboard::reserve(std::size_t count) {
+    popularityById.reserve(count);
+}
+
+void PopularityLeaderboard::upsert(int id, int popularity) {
+    auto it = popularityById.find(id);
+    if (it != popularityById.end()) {
+        if (it->second == popularity) return;
+        ordered.erase(Entry{ it->second, id });
+        it->second = popularity;
+    } else {
+        popularityById.emplace(id, popularity);
+    }
+    ordered.insert(Entry{ popularity, id });
+}
+
+void PopularityLeaderboard::erase(int id) {
+    auto it = popularityById.find(id);
+    if (it == popularityById.end()) return;
+    ordered.erase(Entry{ it->second, id });
+    popularityById.erase(it);
+}
+
+bool PopularityLeaderboard::contains(int id) const {
+    return popularityById.count(id) > 0;
+}
+
+bool PopularityLeaderboard::popularityOf(int id, int& popularity) const {
+    auto it = popularityById.find(id);
+    if (it == popularityById.end()) return false;
+    popularity = it->second;
+    return true;
+}
+
+std::size_t PopularityLeaderboard::size() const {
+    return ordered.size();
+}
+
+void PopularityLeaderboard::forEachTop(std::size_t k,
+                                       const std::function<bool(int id, int popularity)>& visitor) const {
+    for (auto it = ordered.begin(); it != ordered.end() && k > 0; ++it, --k) {
+        if (!visitor(it->id, it->popularity)) return;
+    }
+}
+
+std::vector<int> PopularityLeaderboard::topIds(std::size_t k) const {
+    std::vector<int> ids;
+    ids.reserve(k < ordered.size() ? k : ordered.size());
+    forEachTop(k, [&ids](int id, int) {
+        ids.push_back(id);
+        return true;
+    });
+    return ids;
+}
@@ -1,40 +1,463 @@
 #include "RankingManager.h"
+#include "LocationColumns.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <numeric>
+#include <thread>
+
+namespace {
+// 用大小为 k 的堆从 rows 行中选出前 k 名：堆顶始终是已入选者中排名最靠后的一项
+template <typename PopularityOf, typename IdOf, typename Accept>
+std::vector<std::size_t> selectTop(std::size_t rows, std::size_t k,
+                                   PopularityOf popularityOf, IdOf idOf, Accept accept) {
+    auto better = [&](std::size_t a, std::size_t b) {
+        int pa = popularityOf(a);
+        int pb = popularityOf(b);
+        if (pa != pb) return pa > pb;
+        return idOf(a) < idOf(b);
+    };
+    std::vector<std::size_t> heap;
+    if (k == 0) return heap;
+    heap.reserve(std::min(k, rows));
+    for (std::size_t row = 0; row < rows; ++row) {
+        if (!accept(row)) continue;
+        if (heap.size() < k) {
+            heap.push_back(row);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(row, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = row;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+    return heap;
+}
+
+// 把有符号整数映射为保持大小顺序的无符号键
+std::uint32_t orderedKey(int value) {
+    return static_cast<std::uint32_t>(value) ^ 0x80000000U;
+}
+
+// 对下标排列做一轮稳定的 LSD 基数排序（每轮 8 位，共 4 轮）；
+// 某一轮所有键的该字节都相同时直接跳过，人气值较小时通常只需 1~2 轮。
+void radixSortBy(std::vector<std::size_t>& order, std::vector<std::size_t>& buffer,
+                 const std::vector<std::uint32_t>& keys) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        std::size_t counts[257] = {};
+        for (std::size_t row : order) {
+            ++counts[((keys[row] >> shift) & 0xFFU) + 1];
+        }
+        bool trivial = false;
+        for (int bucket = 1; bucket <= 256; ++bucket) {
+            if (counts[bucket] == order.size()) {
+                trivial = true;
+                break;
+            }
+        }
+        if (trivial) continue;
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            counts[bucket + 1] += counts[bucket];
+        }
+        buffer.resize(order.size());
+        for (std::size_t row : order) {
+            buffer[counts[(keys[row] >> shift) & 0xFFU]++] = row;
+        }
+        order.swap(buffer);
+    }
+}
+
+// 排名用的无符号键：人气取反后升序即人气降序，同人气再比 ID
+struct RankKeys {
+    std::vector<std::uint32_t> popularity;
+    std::vector<std::uint32_t> id;
+
+    bool before(std::size_t a, std::size_t b) const {
+        if (popularity[a] != popularity[b]) return popularity[a] < popularity[b];
+        return id[a] < id[b];
+    }
+};
+
+void fillRankKeys(RankKeys& keys, const std::vector<int>& popularity, const std::vector<int>& ids,
+                  std::size_t begin, std::size_t end) {
+    for (std::size_t row = begin; row < end; ++row) {
+        keys.popularity[row] = ~orderedKey(popularity[row]);
+        keys.id[row] = orderedKey(ids[row]);
+    }
+}
+
+// 先按 ID 升序、再按人气降序做稳定排序，得到“人气降序、同人气 ID 升序”的行号排列
+void radixRankRows(std::vector<std::size_t>& order, const RankKeys& keys) {
+    std::vector<std::size_t> buffer;
+    radixSortBy(order, buffer, keys.id);
+    radixSortBy(order, buffer, keys.popularity);
+}
+
+std::vector<std::size_t> radixRankOrder(const std::vector<int>& popularity, const std::vector<int>& ids) {
+    RankKeys keys{ std::vector<std::uint32_t>(popularity.size()), std::vector<std::uint32_t>(ids.size()) };
+    fillRankKeys(keys, popularity, ids, 0, popularity.size());
+    std::vector<std::size_t> order(popularity.size());
+    std::iota(order.begin(), order.end(), std::size_t{ 0 });
+    radixRankRows(order, keys);
+    return order;
+}
+
+// 在 [0, count) 上均分出 parts 段，对每段并行执行 task(段号, 起点, 终点)
+template <typename Task>
+void runChunks(std::size_t count, unsigned parts, Task task) {
+    std::vector<std::thread> workers;
+    workers.reserve(parts);
+    for (unsigned part = 0; part < parts; ++part) {
+        std::size_t begin = count * part / parts;
+        std::size_t end = count * (part + 1) / parts;
+        workers.emplace_back(task, part, begin, end);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// 并行全量排名：各线程对自己的一段行号做基数排序，再逐轮两两归并。
+// 排序键 (人气, ID) 是全序，结果与线程数无关。
+std::vector<std::size_t> parallelRankOrder(const std::vector<int>& popularity, const std::vector<int>& ids,
+                                           unsigned threads) {
+    const std::size_t count = popularity.size();
+    if (threads <= 1 || count < RankingManager::kParallelRankThreshold) {
+        return radixRankOrder(popularity, ids);
+    }
+    RankKeys keys{ std::vector<std::uint32_t>(count), std::vector<std::uint32_t>(count) };
+    runChunks(count, threads, [&](unsigned, std::size_t begin, std::size_t end) {
+        fillRankKeys(keys, popularity, ids, begin, end);
+    });
+
+    std::vector<std::size_t> bounds(threads + 1);
+    for (unsigned part = 0; part <= threads; ++part) {
+        bounds[part] = count * part / threads;
+    }
+    std::vector<std::size_t> order(count);
+    runChunks(count, threads, [&](unsigned, std::size_t begin, std::size_t end) {
+        std::vector<std::size_t> local(end - begin);
+        std::iota(local.begin(), local.end(), begin);
+        radixRankRows(local, keys);
+        std::copy(local.begin(), local.end(), order.begin() + static_cast<std::ptrdiff_t>(begin));
+    });
+
+    auto before = [&keys](std::size_t a, std::size_t b) { return keys.before(a, b); };
+    std::vector<std::size_t> buffer(count);
+    while (bounds.size() > 2) {
+        std::vector<std::size_t> merged;
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+            if (i + 2 >= bounds.size()) {
+                // 落单的最后一段直接搬到缓冲区
+                std::copy(order.begin() + static_cast<std::ptrdiff_t>(bounds[i]),
+                          order.begin() + static_cast<std::ptrdiff_t>(bounds[i + 1]),
+                          buffer.begin() + static_cast<std::ptrdiff_t>(bounds[i]));
+                continue;
+            }
+            std::size_t lo = bounds[i], mid = bounds[i + 1], hi = bounds[i + 2];
+            workers.emplace_back([&order, &buffer, &before, lo, mid, hi] {
+                std::merge(order.begin() + static_cast<std::ptrdiff_t>(lo), order.begin() + static_cast<std::ptrdiff_t>(mid),
+                           order.begin() + static_cast<std::ptrdiff_t>(mid), order.begin() + static_cast<std::ptrdiff_t>(hi),
+                           buffer.begin() + static_cast<std::ptrdiff_t>(lo), before);
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        merged.push_back(count);
+        bounds.swap(merged);
+        order.swap(buffer);
+    }
+    return order;
+}
+} // namespace
 
 RankingManager::RankingManager(LocationManager* lm) : locationManager(lm) {}
 
-// 快速排序：按 popularity 从高到低
-void RankingManager::quickSort(std::vector<Location>& arr, int left, int right) {
-    if (left >= right) return;
-    int i = left, j = right;
-    Location pivotLoc = arr[left];
-    int pivot = pivotLoc.popularity;
+std::vector<std::size_t> RankingManager::fullRankingRows(const LocationSnapshot& snapshot) const {
+    if (const LocationColumns* columns = snapshot.columns()) {
+        return radixRankOrder(columns->popularityColumn(), columns->idColumn());
+    }
+    std::vector<int> popularity(snapshot.size());
+    std::vector<int> ids(snapshot.size());
+    for (std::size_t row = 0; row < snapshot.size(); ++row) {
+        popularity[row] = snapshot.popularityAt(row);
+        ids[row] = snapshot.idAt(row);
+    }
+    return radixRankOrder(popularity, ids);
+}
+
+// 更新排行索引中的人气和所属类型；已有地点的人气增长同时记入近期热度
+void RankingManager::applyLocation(const LocationView& view, TrendingScores::Clock::time_point now) {
+    int previous = 0;
+    if (leaderboard.popularityOf(view.id, previous) && view.popularity > previous) {
+        trending.addActivity(view.id, static_cast<double>(view.popularity - previous), now);
+    }
+    leaderboard.upsert(view.id, view.popularity);
+
+    auto typeIt = typeById.find(view.id);
+    if (typeIt != typeById.end() && typeIt->second != view.typeId) {
+        categoryBoards[typeIt->second].erase(view.id);
+    }
+    typeById[view.id] = view.typeId;
+    categoryBoards[view.typeId].upsert(view.id, view.popularity);
+}
+
+void RankingManager::dropLocation(int id) {
+    leaderboard.erase(id);
+    trending.erase(id);
+    auto typeIt = typeById.find(id);
+    if (typeIt != typeById.end()) {
+        categoryBoards[typeIt->second].erase(id);
+        typeById.erase(typeIt);
+    }
+}
+
+void RankingManager::syncLeaderboard(const LocationSnapshot& snapshot) {
+    std::vector<LocationManager::Change> changed;
+    if (leaderboardReady && leaderboardGeneration == snapshot.generation()) return;
+    if (leaderboardReady && locationManager->changesSince(leaderboardGeneration, changed)) {
+        // 日志可能包含比 snapshot 更新的改动；按 snapshot 的状态重放同样正确，下次同步时会再次处理。
+        // 同一地点改动多次时增量合并计一次，时刻取最后一次发布，而不是同步发生的时刻
+        std::unordered_map<int, TrendingScores::Clock::time_point> latest;
+        for (const auto& change : changed) {
+            latest[change.id] = change.publishedAt;
+        }
+        for (const auto& [id, publishedAt] : latest) {
+            LocationView view{};
+            if (snapshot.viewLocation(id, view)) {
+                applyLocation(view, publishedAt);
+            } else {
+                dropLocation(id);
+            }
+        }
+    } else {
+        // 日志已截断，逐条时刻不可考，增量按 snapshot 的发布时刻计
+        auto now = snapshot.publishedAt();
+        // 全量重建：保留旧的总榜用于对比人气增量，使近期热度不因重建丢失。
+        // 整体重载后类型编号可能变化，分类榜单一并重建。
+        PopularityLeaderboard previous;
+        std::swap(previous, leaderboard);
+        categoryBoards.clear();
+        typeById.clear();
+        leaderboard.reserve(snapshot.size());
+        typeById.reserve(snapshot.size());
+        snapshot.forEachLocation([&](const LocationView& view) {
+            int before = 0;
+            if (previous.popularityOf(view.id, before)) {
+                leaderboard.upsert(view.id, before);
+            }
+            applyLocation(view, now);
+        });
+        if (leaderboardReady) {
+            previous.forEachTop(previous.size(), [&](int id, int) {
+                if (!leaderboard.contains(id)) {
+                    trending.erase(id);
+                }
+                return true;
+            });
+        }
+        leaderboardReady = true;
+    }
+    leaderboardGeneration = snapshot.generation();
+}
+
+std::vector<LocationView> RankingManager::topViewsByType(const std::string& type, std::size_t k) {
+    auto snapshot = locationManager->snapshot();
+    TypeId typeId = snapshot->typeDictionary().find(type);
+    if (typeId == TypeDictionary::kInvalidType) return {};
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(leaderboardMutex);
+        syncLeaderboard(*snapshot);
+        auto it = categoryBoards.find(typeId);
+        if (it != categoryBoards.end()) {
+            ids = it->second.topIds(k);
+        }
+    }
+    std::vector<LocationView> views;
+    views.reserve(ids.size());
+    for (int id : ids) {
+        LocationView view{};
+        if (snapshot->viewLocation(id, view)) {
+            views.push_back(view);
+        }
+    }
+    return views;
+}
 
-    while (i < j) {
-        while (i < j && arr[j].popularity <= pivot) --j;
-        if (i < j) arr[i++] = arr[j];
-        while (i < j && arr[i].popularity >= pivot) ++i;
-        if (i < j) arr[j--] = arr[i];
+std::vector<LocationView> RankingManager::topViews(const LocationSnapshot& snapshot, std::size_t k) {
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(leaderboardMutex);
+        syncLeaderboard(snapshot);
+        ids = leaderboard.topIds(k);
+    }
+    std::vector<LocationView> views;
+    views.reserve(ids.size());
+    for (int id : ids) {
+        LocationView view{};
+        if (snapshot.viewLocation(id, view)) {
+            views.push_back(view);
+        }
     }
-    arr[i] = pivotLoc;
-    quickSort(arr, left, i - 1);
-    quickSort(arr, i + 1, right);
+    return views;
+}
+
+std::vector<LocationView> RankingManager::topViews(std::size_t k) {
+    return topViews(*locationManager->snapshot(), k);
+}
+
+std::vector<LocationView> RankingManager::rankedViews() {
+    auto snapshot = locationManager->snapshot();
+    return topViews(*snapshot, snapshot->size());
 }
 
 std::vector<Location> RankingManager::rankByPopularity() {
-    std::vector<Location> all = locationManager->getAllLocations();
-    if (all.empty()) return {};
-    quickSort(all, 0, static_cast<int>(all.size()) - 1);
-    return all;
+    auto snapshot = locationManager->snapshot();
+    return materialize(*snapshot, fullRankingRows(*snapshot));
+}
+
+std::vector<Location> RankingManager::rankByPopularityParallel(unsigned threads) {
+    if (threads <= 1 || locationManager->size() < kParallelRankThreshold) {
+        return rankByPopularity();
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<std::size_t> order;
+    if (const LocationColumns* columns = snapshot->columns()) {
+        order = parallelRankOrder(columns->popularityColumn(), columns->idColumn(), threads);
+    } else {
+        std::vector<int> popularity(snapshot->size());
+        std::vector<int> ids(snapshot->size());
+        for (std::size_t row = 0; row < snapshot->size(); ++row) {
+            popularity[row] = snapshot->popularityAt(row);
+            ids[row] = snapshot->idAt(row);
+        }
+        order = parallelRankOrder(popularity, ids, threads);
+    }
+    return materializeParallel(*snapshot, order, threads);
+}
+
+std::vector<std::size_t> RankingManager::selectTopRows(const LocationSnapshot& snapshot, std::size_t k,
+                                                      TypeId typeFilter) const {
+    const bool filtered = typeFilter != TypeDictionary::kInvalidType;
+    if (const LocationColumns* columns = snapshot.columns()) {
+        const auto& popularity = columns->popularityColumn();
+        const auto& ids = columns->idColumn();
+        const auto& typeIds = columns->typeColumn();
+        return selectTop(
+            popularity.size(), k,
+            [&](std::size_t row) { return popularity[row]; },
+            [&](std::size_t row) { return ids[row]; },
+            [&](std::size_t row) { return !filtered || typeIds[row] == typeFilter; });
+    }
+    return selectTop(
+        snapshot.size(), k,
+        [&](std::size_t row) { return snapshot.popularityAt(row); },
+        [&](std::size_t row) { return snapshot.idAt(row); },
+        [&](std::size_t row) { return !filtered || snapshot.typeAt(row) == typeFilter; });
+}
+
+std::vector<Location> RankingManager::materializeParallel(const LocationSnapshot& snapshot,
+                                                          const std::vector<std::size_t>& rows,
+                                                          unsigned threads) const {
+    if (threads <= 1 || rows.size() < kParallelRankThreshold) {
+        return materialize(snapshot, rows);
+    }
+    std::vector<Location> result(rows.size());
+    runChunks(rows.size(), threads, [&](unsigned, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            result[i] = snapshot.viewAt(rows[i]).toLocation();
+        }
+    });
+    fillDescriptions(result);
+    return result;
+}
+
+std::vector<Location> RankingManager::materialize(const LocationSnapshot& snapshot,
+                                                  const std::vector<std::size_t>& rows) const {
+    std::vector<Location> result;
+    result.reserve(rows.size());
+    for (std::size_t row : rows) {
+        result.push_back(snapshot.viewAt(row).toLocation());
+    }
+    fillDescriptions(result);
+    return result;
+}
+
+void RankingManager::fillDescriptions(std::vector<Location>& locations) const {
+    if (!locationManager->lazyDescriptionsEnabled()) return;
+    // 描述在磁盘上：一次顺序读完，而不是每行单独打开文件
+    std::vector<int> ids;
+    ids.reserve(locations.size());
+    for (const auto& loc : locations) {
+        ids.push_back(loc.id);
+    }
+    auto texts = locationManager->descriptions(ids);
+    for (std::size_t i = 0; i < locations.size(); ++i) {
+        locations[i].description = std::move(texts[i]);
+    }
+}
+
+std::vector<Location> RankingManager::rankTopK(std::size_t k) {
+    auto snapshot = locationManager->snapshot();
+    return materialize(*snapshot, selectTopRows(*snapshot, k, TypeDictionary::kInvalidType));
+}
+
+std::vector<Location> RankingManager::rankTopKByType(const std::string& type, std::size_t k) {
+    auto snapshot = locationManager->snapshot();
+    TypeId typeId = snapshot->typeDictionary().find(type);
+    if (typeId == TypeDictionary::kInvalidType) return {};
+    return materialize(*snapshot, selectTopRows(*snapshot, k, typeId));
+}
+
+std::vector<LocationView> RankingManager::trendingViews(std::size_t k) {
+    auto snapshot = locationManager->snapshot();
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(leaderboardMutex);
+        syncLeaderboard(*snapshot);
+        trending.forEachTop(k, [&ids](int id, double) {
+            ids.push_back(id);
+            return true;
+        });
+    }
+    std::vector<LocationView> views;
+    views.reserve(ids.size());
+    for (int id : ids) {
+        LocationView view{};
+        if (snapshot->viewLocation(id, view)) {
+            views.push_back(view);
+        }
+    }
+    return views;
+}
+
+void RankingManager::setTrendingHalfLife(double hours) {
+    std::lock_guard<std::mutex> lock(leaderboardMutex);
+    trending.setHalfLife(hours * 3600.0);
 }
 
 void RankingManager::printRanking() {
-    auto ranking = rankByPopularity();
+    auto snapshot = locationManager->snapshot();
+    auto ranking = topViews(*snapshot, snapshot->size());
+    std::vector<std::string> texts;
+    if (locationManager->lazyDescriptionsEnabled()) {
+        std::vector<int> ids;
+        ids.reserve(ranking.size());
+        for (const auto& loc : ranking) {
+            ids.push_back(loc.id);
+        }
+        texts = locationManager->descriptions(ids);
+    }
     std::cout << "===== 热门地点排行榜 =====\n";
-    int rank = 1;
-    for (const auto& loc : ranking) {
-        std::cout << rank++ << ". " << loc.name
+    for (std::size_t i = 0; i < ranking.size(); ++i) {
+        const auto& loc = ranking[i];
+        std::cout << i + 1 << ". " << loc.name
             << " (人气: " << loc.popularity << ") - "
-            << loc.type << " - " << loc.description << "\n";
+            << loc.type << " - " << (texts.empty() ? loc.description : std::string_view(texts[i])) << "\n";
     }
 }
@@ -0,0 +1,106 @@
+#include "RelevanceIndex.h"
+#include "NgramIndex.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+#include <cmath>
+
+double RelevanceIndex::score(MatchKind kind, int popularity) {
+    double quality = kind == MatchKind::Exact ? 4.0 : kind == MatchKind::Prefix ? 2.0 : 1.0;
+    return quality * (1.0 + std::log10(1.0 + std::max(popularity, 0)));
+}
+
+bool RelevanceIndex::ranksBefore(const Entry& a, const Entry& b) {
+    if (a.popularity != b.popularity) return a.popularity > b.popularity;
+    return a.id < b.id;
+}
+
+void RelevanceIndex::insertEntry(std::vector<Entry>& list, const Entry& entry) {
+    list.insert(std::lower_bound(list.begin(), list.end(), entry, ranksBefore), entry);
+}
+
+void RelevanceIndex::eraseEntry(std::vector<Entry>& list, const Entry& entry) {
+    auto it = std::lower_bound(list.begin(), list.end(), entry, ranksBefore);
+    if (it != list.end() && it->id == entry.id) {
+        list.erase(it);
+    }
+}
+
+void RelevanceIndex::insertItem(int id, const Item& item) {
+    Entry entry{item.popularity, id};
+    for (std::uint64_t gram : NgramIndex::nameGrams(decodeUtf8(item.lowerName))) {
+        insertEntry(impactLists[gram], entry);
+    }
+    insertEntry(allEntries, entry);
+}
+
+void RelevanceIndex::eraseItem(int id, const Item& item) {
+    Entry entry{item.popularity, id};
+    for (std::uint64_t gram : NgramIndex::nameGrams(decodeUtf8(item.lowerName))) {
+        auto list = impactLists.find(gram);
+        if (list == impactLists.end()) continue;
+        eraseEntry(list->second, entry);
+        if (list->second.empty()) {
+            impactLists.erase(list);
+        }
+    }
+    eraseEntry(allEntries, entry);
+}
+
+void RelevanceIndex::clear() {
+    impactLists.clear();
+    allEntries.clear();
+    items.clear();
+}
+
+void RelevanceIndex::upsert(int id, std::string_view name, int popularity) {
+    Item next{asciiLower(name), popularity};
+    auto it = items.find(id);
+    if (it == items.end()) {
+        insertItem(id, next);
+        items.emplace(id, std::move(next));
+        return;
+    }
+    Item& current = it->second;
+    if (current.lowerName == next.lowerName && current.popularity == next.popularity) return;
+    // 人气变化也要在每张倒排表里挪位置；表内按人气有序，二分定位后只搬动一段元素
+    eraseItem(id, current);
+    current = std::move(next);
+    insertItem(id, current);
+}
+
+void RelevanceIndex::remove(int id) {
+    auto it = items.find(id);
+    if (it == items.end()) return;
+    eraseItem(id, it->second);
+    items.erase(it);
+}
+
+std::size_t RelevanceIndex::size() const {
+    return items.size();
+}
+
+void RelevanceIndex::forEachInfixMatch(std::string_view keyword, const std::function<bool(int, int)>& admits,
+                                       const std::function<void(int, int)>& visitor) const {
+    std::string lowered = asciiLower(keyword);
+    bool partial = false;
+    auto grams = NgramIndex::queryGrams(decodeUtf8(lowered), partial);
+
+    // 命中必须包含全部 gram，因此只需遍历其中最短的一张表，其余条件交给名称核对
+    const std::vector<Entry>* driver = &allEntries;
+    for (std::uint64_t gram : grams) {
+        auto it = impactLists.find(gram);
+        if (it == impactLists.end()) return;
+        if (driver == &allEntries || it->second.size() < driver->size()) {
+            driver = &it->second;
+        }
+    }
+
+    for (const Entry& entry : *driver) {
+        if (!admits(entry.popularity, entry.id)) return;
+        const std::string& name = items.at(entry.id).lowerName;
+        if (name.compare(0, lowered.size(), lowered) == 0) continue; // 前缀匹配由调用方另行处理
+        if (name.find(lowered) == std::string::npos) continue;
+        visitor(entry.id, entry.popularity);
+    }
+}
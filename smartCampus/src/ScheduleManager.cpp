@@ -1,6 +1,8 @@
 #include "ScheduleManager.h"
 
+#include <algorithm>
 #include <cctype>
+#include <numeric>
 #include <stdexcept>
 
 long long ScheduleManager::toKey(const std::string& timeStr) {
@@ -29,54 +31,93 @@ long long ScheduleManager::toKey(const std::string& timeStr) {
            static_cast<long long>(minute);
 }
 
-ScheduleManager::Node* ScheduleManager::insert(Node* node, const Activity& activity) {
+bool ScheduleManager::comesBefore(long long key, int id, const Node* node) {
+    return key < node->key || (key == node->key && id < node->data.id);
+}
+
+int ScheduleManager::heightOf(const Node* node) {
+    return node ? node->height : 0;
+}
+
+void ScheduleManager::updateHeight(Node* node) {
+    node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+}
+
+ScheduleManager::Node* ScheduleManager::rotateLeft(Node* node) {
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+ScheduleManager::Node* ScheduleManager::rotateRight(Node* node) {
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    updateHeight(node);
+    updateHeight(pivot);
+    return pivot;
+}
+
+ScheduleManager::Node* ScheduleManager::rebalance(Node* node) {
+    updateHeight(node);
+    int balance = heightOf(node->left) - heightOf(node->right);
+    if (balance > 1) {
+        if (heightOf(node->left->left) < heightOf(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        if (heightOf(node->right->right) < heightOf(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+ScheduleManager::Node* ScheduleManager::insert(Node* node, Node* fresh) {
     if (!node) {
-        Node* newNode = new Node();
-        newNode->data = activity;
-        return newNode;
+        return fresh;
     }
-    long long key = toKey(activity.startTime);
-    long long currentKey = toKey(node->data.startTime);
-    if (key < currentKey || (key == currentKey && activity.id < node->data.id)) {
-        node->left = insert(node->left, activity);
+    // 时间与 ID 都相同的活动排在已有活动之后，保持插入顺序
+    if (comesBefore(fresh->key, fresh->data.id, node)) {
+        node->left = insert(node->left, fresh);
     } else {
-        node->right = insert(node->right, activity);
+        node->right = insert(node->right, fresh);
     }
+    return rebalance(node);
+}
+
+ScheduleManager::Node* ScheduleManager::buildBalanced(const std::vector<Node*>& nodes, std::size_t begin,
+                                                      std::size_t end) {
+    if (begin == end) return nullptr;
+    std::size_t mid = begin + (end - begin) / 2;
+    Node* node = nodes[mid];
+    node->left = buildBalanced(nodes, begin, mid);
+    node->right = buildBalanced(nodes, mid + 1, end);
+    updateHeight(node);
     return node;
 }
 
-void ScheduleManager::inOrder(Node* node, std::vector<Activity>& out) {
+void ScheduleManager::collectNodes(Node* node, std::vector<Node*>& out) {
+    if (!node) return;
+    collectNodes(node->left, out);
+    out.push_back(node);
+    collectNodes(node->right, out);
+}
+
+void ScheduleManager::inOrder(const Node* node, std::vector<Activity>& out) {
     if (!node) return;
     inOrder(node->left, out);
     out.push_back(node->data);
     inOrder(node->right, out);
 }
 
-ScheduleManager::Node* ScheduleManager::mergeSubtrees(Node* left, Node* right) {
-    if (!left) return right;
-    if (!right) return left;
-    Node* cursor = left;
-    while (cursor->right) {
-        cursor = cursor->right;
-    }
-    cursor->right = right;
-    return left;
-}
-
-ScheduleManager::Node* ScheduleManager::removeExpired(Node* node, long long key) {
-    if (!node) return nullptr;
-    node->left = removeExpired(node->left, key);
-    node->right = removeExpired(node->right, key);
-    long long nodeKey = toKey(node->data.startTime);
-    if (nodeKey < key) {
-        Node* merged = mergeSubtrees(node->left, node->right);
-        delete node;
-        return merged;
-    }
-    return node;
-}
-
-void ScheduleManager::preOrder(Node* node, std::vector<Activity>& out) {
+void ScheduleManager::preOrder(const Node* node, std::vector<Activity>& out) {
     if (!node) return;
     out.push_back(node->data);
     preOrder(node->left, out);
@@ -95,7 +136,12 @@ ScheduleManager::~ScheduleManager() {
 }
 
 void ScheduleManager::addActivity(const Activity& activity) {
-    root = insert(root, activity);
+    long long key = toKey(activity.startTime);
+    Node* fresh = new Node();
+    fresh->data = activity;
+    fresh->key = key;
+    root = insert(root, fresh);
+    ++generationCounter;
 }
 
 std::vector<Activity> ScheduleManager::generateSchedule() const {
@@ -107,7 +153,22 @@ std::vector<Activity> ScheduleManager::generateSchedule() const {
 
 void ScheduleManager::clearExpired(const std::string& currentTime) {
     long long key = toKey(currentTime);
-    root = removeExpired(root, key);
+    const Node* earliest = root;
+    while (earliest && earliest->left) {
+        earliest = earliest->left;
+    }
+    if (earliest && earliest->key < key) {
+        // 过期活动正好是有序序列的一段前缀：删掉前缀后用剩下的节点重新建平衡树
+        std::vector<Node*> nodes;
+        collectNodes(root, nodes);
+        auto firstKept = std::partition_point(nodes.begin(), nodes.end(),
+                                              [key](const Node* node) { return node->key < key; });
+        for (auto it = nodes.begin(); it != firstKept; ++it) {
+            delete *it;
+        }
+        root = buildBalanced(nodes, static_cast<std::size_t>(firstKept - nodes.begin()), nodes.size());
+    }
+    ++generationCounter;
 }
 
 std::vector<Activity> ScheduleManager::backup() const {
@@ -120,11 +181,39 @@ std::vector<Activity> ScheduleManager::backup() const {
 void ScheduleManager::clear() {
     destroy(root);
     root = nullptr;
+    ++generationCounter;
 }
 
 void ScheduleManager::loadFromActivities(const std::vector<Activity>& activities) {
-    clear();
+    // 先算出全部键：有时间格式非法的活动时抛出异常，原有日程保持不变
+    std::vector<long long> keys;
+    keys.reserve(activities.size());
     for (const auto& activity : activities) {
-        addActivity(activity);
+        keys.push_back(toKey(activity.startTime));
     }
+    std::vector<std::size_t> order(activities.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto before = [&](std::size_t a, std::size_t b) {
+        if (keys[a] != keys[b]) return keys[a] < keys[b];
+        return activities[a].id < activities[b].id;
+    };
+    if (!std::is_sorted(order.begin(), order.end(), before)) {
+        std::stable_sort(order.begin(), order.end(), before);
+    }
+
+    clear();
+    std::vector<Node*> nodes;
+    nodes.reserve(order.size());
+    for (std::size_t index : order) {
+        Node* node = new Node();
+        node->data = activities[index];
+        node->key = keys[index];
+        nodes.push_back(node);
+    }
+    root = buildBalanced(nodes, 0, nodes.size());
+    ++generationCounter;
+}
+
+std::uint64_t ScheduleManager::generation() const {
+    return generationCounter;
 }
@@ -1,16 +1,190 @@
 #include "SearchManager.h"
+#include "CaseInsensitiveSearch.h"
+#include "PinyinInitials.h"
+#include "TextUtils.h"
 
-#include <cctype>
+#include <algorithm>
 
 SearchManager::SearchManager(LocationManager* lm) : locationManager(lm) {}
 
-std::string SearchManager::toLower(const std::string& text) {
-    std::string res;
-    res.reserve(text.size());
-    for (unsigned char ch : text) {
-        res.push_back(static_cast<char>(std::tolower(ch)));
+void SearchManager::indexText(const LocationView& view) const {
+    if (locationManager->lazyDescriptionsEnabled()) {
+        // 描述留在磁盘上，视图中为空，需要单独读取（有 LRU 缓存）
+        std::string description = locationManager->description(view.id);
+        fullText.add(view.id, view.name, view.type, description, view.popularity);
+    } else {
+        fullText.add(view.id, view.name, view.type, view.description, view.popularity);
     }
-    return res;
+}
+
+void SearchManager::syncIndex(const LocationSnapshot& snapshot, IndexState& state, const std::function<void()>& reset,
+                              const std::function<void(const LocationView&)>& upsert,
+                              const std::function<void(int)>& drop) const {
+    if (state.ready && state.generation == snapshot.generation()) return;
+    std::vector<int> changed;
+    if (state.ready && locationManager->changesSince(state.generation, changed)) {
+        // 与排行榜相同：按当前快照重放变更 ID，重复处理是幂等的
+        for (int id : changed) {
+            LocationView view{};
+            if (snapshot.viewLocation(id, view)) {
+                upsert(view);
+            } else {
+                drop(id);
+            }
+        }
+    } else {
+        reset();
+        snapshot.forEachLocation(upsert);
+        state.ready = true;
+    }
+    state.generation = snapshot.generation();
+}
+
+void SearchManager::syncNameIndex(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, nameState, [this] { nameIndex.clear(); },
+        [this](const LocationView& view) { nameIndex.add(view.id, view.name); },
+        [this](int id) { nameIndex.remove(id); });
+}
+
+void SearchManager::syncRankIndex(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, rankState, [this] { rankIndex.clear(); },
+        [this](const LocationView& view) { rankIndex.upsert(view.id, view.name, view.popularity); },
+        [this](int id) { rankIndex.remove(id); });
+}
+
+void SearchManager::syncCompletions(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, completionState, [this] { completions.clear(); },
+        [this](const LocationView& view) { completions.upsert(view.id, view.name, view.popularity); },
+        [this](int id) { completions.remove(id); });
+}
+
+void SearchManager::syncFuzzyIndex(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, fuzzyState, [this] { fuzzyIndex.clear(); },
+        [this](const LocationView& view) { fuzzyIndex.add(view.id, view.name); },
+        [this](int id) { fuzzyIndex.remove(id); });
+}
+
+void SearchManager::syncFilterIndex(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, filterState, [this] { filterIndex.clear(); },
+        [this](const LocationView& view) { filterIndex.add(view.id, view.typeId, view.popularity); },
+        [this](int id) { filterIndex.remove(id); });
+}
+
+void SearchManager::syncPinyinIndex(const LocationSnapshot& snapshot) const {
+    syncIndex(
+        snapshot, pinyinState, [this] { pinyinIndex.clear(); },
+        [this](const LocationView& view) { pinyinIndex.add(view.id, pinyinInitials(view.name)); },
+        [this](int id) { pinyinIndex.remove(id); });
+}
+
+void SearchManager::syncFullText(const LocationSnapshot& snapshot) const {
+    if (fullTextState.ready && fullTextState.generation == snapshot.generation()) return;
+    std::vector<int> changed;
+    std::vector<int> popularityOnly;
+    if (fullTextState.ready && locationManager->changesSince(fullTextState.generation, changed, popularityOnly)) {
+        // 访问计数写回只改人气：就地更新得分，不读描述也不重新分词
+        for (int id : popularityOnly) {
+            LocationView view{};
+            if (!snapshot.viewLocation(id, view)) {
+                fullText.remove(id);
+            } else if (!fullText.setPopularity(id, view.popularity)) {
+                indexText(view);
+            }
+        }
+        for (int id : changed) {
+            LocationView view{};
+            if (snapshot.viewLocation(id, view)) {
+                indexText(view);
+            } else {
+                fullText.remove(id);
+            }
+        }
+    } else {
+        fullText.clear();
+        if (locationManager->lazyDescriptionsEnabled()) {
+            // 顺序读一遍数据文件补齐描述，避免逐条打开文件。
+            // 读到的版本可能比 snapshot 新，下次同步重放日志时会再校正一遍
+            for (const auto& loc : locationManager->getAllLocations()) {
+                fullText.add(loc.id, loc.name, loc.type, loc.description, loc.popularity);
+            }
+        } else {
+            snapshot.forEachLocation([&](const LocationView& view) {
+                fullText.add(view.id, view.name, view.type, view.description, view.popularity);
+            });
+        }
+        fullTextState.ready = true;
+    }
+    fullTextState.generation = snapshot.generation();
+}
+
+std::vector<std::size_t> SearchManager::rowsInOrder(const LocationSnapshot& snapshot, const std::vector<int>& ids) {
+    std::vector<std::size_t> rows;
+    rows.reserve(ids.size());
+    for (int id : ids) {
+        std::size_t row = 0;
+        if (snapshot.rowOf(id, row)) {
+            rows.push_back(row);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+SearchManager::RowList SearchManager::matchingRows(const LocationSnapshot& snapshot,
+                                                  const std::string& keyword) const {
+    // 名称匹配只忽略 ASCII 大小写，按同样规则规范化即可让“Lab”与“lab”共用一个条目；
+    // 空白有意义（“lab ”与“lab”结果不同），不做裁剪
+    std::string key = asciiLower(keyword);
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        CachedQuery cached;
+        if (queryCache.get(key, cached) && cached.generation == snapshot.generation()) {
+            ++cacheHits;
+            return cached.rows;
+        }
+        ++cacheMisses;
+    }
+    // 缓存保存行号而不是 ID：代数相同即为同一份快照，行号同样有效，命中时省去逐个查行
+    auto rows = std::make_shared<const std::vector<std::size_t>>(computeMatchingRows(snapshot, keyword));
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        CachedQuery existing;
+        // 并发查询时不要用旧快照的结果覆盖较新的条目
+        if (!queryCache.get(key, existing) || existing.generation <= snapshot.generation()) {
+            queryCache.put(key, CachedQuery{snapshot.generation(), rows});
+        }
+    }
+    return rows;
+}
+
+std::vector<std::size_t> SearchManager::computeMatchingRows(const LocationSnapshot& snapshot,
+                                                           const std::string& keyword) const {
+    std::vector<int> ids;
+    bool indexed = false;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (nameIndexing) {
+            syncNameIndex(snapshot);
+            ids = nameIndex.search(keyword);
+            indexed = true;
+        }
+    }
+    if (indexed) {
+        return rowsInOrder(snapshot, ids);
+    }
+    // 无索引路径：直接在快照的名称上做不区分大小写的子串比较，不复制字符串
+    std::vector<std::size_t> rows;
+    for (std::size_t row = 0; row < snapshot.size(); ++row) {
+        if (containsIgnoreCase(snapshot.viewAt(row).name, keyword)) {
+            rows.push_back(row);
+        }
+    }
+    return rows;
 }
 
 std::vector<Location> SearchManager::searchByName(const std::string& keyword) const {
@@ -18,15 +192,362 @@ std::vector<Location> SearchManager::searchByName(const std::string& keyword) co
     if (!locationManager) {
         return matches;
     }
-    auto all = locationManager->getAllLocations();
     if (keyword.empty()) {
-        return all;
+        return locationManager->getAllLocations();
+    }
+    auto snapshot = locationManager->snapshot();
+    auto rows = matchingRows(*snapshot, keyword);
+    matches.reserve(rows->size());
+    for (std::size_t row : *rows) {
+        matches.push_back(snapshot->viewAt(row).toLocation());
+    }
+    return matches;
+}
+
+std::size_t SearchManager::searchByName(const std::string& keyword, std::size_t offset, std::size_t limit,
+                                        const std::function<void(const LocationView&)>& visitor) const {
+    if (!locationManager) {
+        return 0;
+    }
+    auto snapshot = locationManager->snapshot();
+    if (keyword.empty()) {
+        for (std::size_t row = offset; row < snapshot->size() && row - offset < limit; ++row) {
+            visitor(snapshot->viewAt(row));
+        }
+        return snapshot->size();
+    }
+    auto rows = matchingRows(*snapshot, keyword);
+    for (std::size_t i = offset; i < rows->size() && i - offset < limit; ++i) {
+        visitor(snapshot->viewAt((*rows)[i]));
+    }
+    return rows->size();
+}
+
+std::vector<int> SearchManager::searchIdsByName(const std::string& keyword) const {
+    std::vector<int> ids;
+    if (!locationManager) {
+        return ids;
     }
-    std::string keyLower = toLower(keyword);
-    for (const auto& loc : all) {
-        if (toLower(loc.name).find(keyLower) != std::string::npos) {
-            matches.push_back(loc);
+    auto snapshot = locationManager->snapshot();
+    if (keyword.empty()) {
+        ids.reserve(snapshot->size());
+        for (std::size_t row = 0; row < snapshot->size(); ++row) {
+            ids.push_back(snapshot->idAt(row));
         }
+        return ids;
     }
+    auto rows = matchingRows(*snapshot, keyword);
+    ids.reserve(rows->size());
+    for (std::size_t row : *rows) {
+        ids.push_back(snapshot->idAt(row));
+    }
+    return ids;
+}
+
+double SearchManager::QueryCacheStats::hitRate() const {
+    std::size_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+}
+
+void SearchManager::setQueryCacheCapacity(std::size_t capacity) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    queryCache.setCapacity(capacity);
+}
+
+SearchManager::QueryCacheStats SearchManager::queryCacheStats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    QueryCacheStats stats;
+    stats.hits = cacheHits;
+    stats.misses = cacheMisses;
+    stats.entries = queryCache.size();
+    stats.capacity = queryCache.capacity();
+    return stats;
+}
+
+void SearchManager::resetQueryCacheStats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheHits = 0;
+    cacheMisses = 0;
+}
+
+void SearchManager::setNameIndexing(bool enabled) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (enabled == nameIndexing) return;
+    nameIndexing = enabled;
+    nameIndex.clear();
+    rankIndex.clear();
+    // 重新启用时需要全量重建
+    nameState.ready = false;
+    rankState.ready = false;
+}
+
+bool SearchManager::nameIndexingEnabled() const {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return nameIndexing;
+}
+
+std::vector<Location> SearchManager::suggest(const std::string& prefix, std::size_t k) const {
+    std::vector<Location> suggestions;
+    if (!locationManager || k == 0) {
+        return suggestions;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncCompletions(*snapshot);
+        ids = completions.complete(prefix, k);
+    }
+    suggestions.reserve(ids.size());
+    for (int id : ids) {
+        LocationView view{};
+        if (snapshot->viewLocation(id, view)) {
+            suggestions.push_back(view.toLocation());
+        }
+    }
+    return suggestions;
+}
+
+bool SearchManager::findIdByName(const std::string& name, int& id) const {
+    if (!locationManager) {
+        return false;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<int> candidates;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncCompletions(*snapshot);
+        candidates = completions.exactMatches(name);
+    }
+    // 字典树按 ASCII 不区分大小写匹配，这里再逐个核对原名
+    bool found = false;
+    std::size_t bestRow = 0;
+    for (int candidate : candidates) {
+        std::size_t row = 0;
+        if (!snapshot->rowOf(candidate, row) || snapshot->viewAt(row).name != name) continue;
+        if (!found || row < bestRow) {
+            found = true;
+            bestRow = row;
+        }
+    }
+    if (found) {
+        id = snapshot->idAt(bestRow);
+    }
+    return found;
+}
+
+std::vector<Location> SearchManager::searchByPinyin(const std::string& initials) const {
+    std::vector<Location> matches;
+    // '|' 是多音字候选之间的分隔符，不能出现在查询里
+    if (!locationManager || initials.empty() || initials.find('|') != std::string::npos) {
+        return matches;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncPinyinIndex(*snapshot);
+        ids = pinyinIndex.search(initials);
+    }
+    auto rows = rowsInOrder(*snapshot, ids);
+    matches.reserve(rows.size());
+    for (std::size_t row : rows) {
+        matches.push_back(snapshot->viewAt(row).toLocation());
+    }
+    return matches;
+}
+
+std::vector<Location> SearchManager::fuzzySearch(const std::string& keyword, int maxDistance, std::size_t limit) const {
+    std::vector<Location> matches;
+    if (!locationManager || keyword.empty() || limit == 0) {
+        return matches;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<std::pair<int, int>> found;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncFuzzyIndex(*snapshot);
+        found = fuzzyIndex.search(keyword, maxDistance);
+    }
+    struct Candidate {
+        int distance;
+        LocationView view;
+    };
+    std::vector<Candidate> candidates;
+    candidates.reserve(found.size());
+    for (const auto& hit : found) {
+        LocationView view{};
+        if (snapshot->viewLocation(hit.second, view)) {
+            candidates.push_back({hit.first, view});
+        }
+    }
+    std::size_t count = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                      [](const Candidate& a, const Candidate& b) {
+                          if (a.distance != b.distance) return a.distance < b.distance;
+                          if (a.view.popularity != b.view.popularity) return a.view.popularity > b.view.popularity;
+                          return a.view.id < b.view.id;
+                      });
+    matches.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        matches.push_back(candidates[i].view.toLocation());
+    }
+    return matches;
+}
+
+std::vector<Location> SearchManager::rankedSearch(const std::string& keyword, std::size_t k) const {
+    std::vector<Location> matches;
+    if (!locationManager || keyword.empty() || k == 0) {
+        return matches;
+    }
+    auto snapshot = locationManager->snapshot();
+    struct Scored {
+        double score;
+        int popularity;
+        int id;
+    };
+    // 同分（例如人气都不大于 0）时按人气、再按 ID，与补全树和人气倒排表内的顺序一致
+    auto ranksBefore = [](const Scored& a, const Scored& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.popularity != b.popularity) return a.popularity > b.popularity;
+        return a.id < b.id;
+    };
+    // 小顶堆保存当前前 k 名，堆顶是第 k 名
+    std::vector<Scored> heap;
+    auto offer = [&](const Scored& candidate) {
+        if (heap.size() < k) {
+            heap.push_back(candidate);
+            std::push_heap(heap.begin(), heap.end(), ranksBefore);
+        } else if (ranksBefore(candidate, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), ranksBefore);
+            heap.back() = candidate;
+            std::push_heap(heap.begin(), heap.end(), ranksBefore);
+        }
+    };
+    auto scored = [](RelevanceIndex::MatchKind kind, int popularity, int id) {
+        return Scored{RelevanceIndex::score(kind, popularity), popularity, id};
+    };
+    auto offerById = [&](RelevanceIndex::MatchKind kind, int id) {
+        std::size_t row = 0;
+        if (snapshot->rowOf(id, row)) offer(scored(kind, snapshot->popularityAt(row), id));
+    };
+
+    bool indexed = false;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (nameIndexing) {
+            syncCompletions(*snapshot);
+            syncRankIndex(*snapshot);
+            indexed = true;
+            // 完全匹配与前缀匹配从补全树取：前缀部分按人气有序，前 k 个之后的不可能胜出
+            auto exact = completions.exactMatches(keyword);
+            for (int id : exact) {
+                offerById(RelevanceIndex::MatchKind::Exact, id);
+            }
+            std::sort(exact.begin(), exact.end());
+            for (int id : completions.complete(keyword, k + exact.size())) {
+                if (std::binary_search(exact.begin(), exact.end(), id)) continue;
+                offerById(RelevanceIndex::MatchKind::Prefix, id);
+            }
+            // 剩下的只可能是子串匹配，得分上界随人气单调递减：上界排不进前 k 名即可停止
+            rankIndex.forEachInfixMatch(
+                keyword,
+                [&](int popularity, int id) {
+                    return heap.size() < k ||
+                           ranksBefore(scored(RelevanceIndex::MatchKind::Substring, popularity, id), heap.front());
+                },
+                [&](int id, int popularity) {
+                    offer(scored(RelevanceIndex::MatchKind::Substring, popularity, id));
+                });
+        }
+    }
+    if (!indexed) {
+        // 无索引路径：逐条原地比较名称并打分
+        for (std::size_t row = 0; row < snapshot->size(); ++row) {
+            std::string_view name = snapshot->viewAt(row).name;
+            if (!containsIgnoreCase(name, keyword)) continue;
+            RelevanceIndex::MatchKind kind = RelevanceIndex::MatchKind::Substring;
+            if (name.size() == keyword.size()) {
+                kind = RelevanceIndex::MatchKind::Exact;
+            } else if (containsIgnoreCase(name.substr(0, keyword.size()), keyword)) {
+                kind = RelevanceIndex::MatchKind::Prefix;
+            }
+            offer(scored(kind, snapshot->popularityAt(row), snapshot->idAt(row)));
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), ranksBefore);
+    matches.reserve(heap.size());
+    for (const Scored& hit : heap) {
+        LocationView view{};
+        if (snapshot->viewLocation(hit.id, view)) {
+            matches.push_back(view.toLocation());
+        }
+    }
+    return matches;
+}
+
+std::vector<Location> SearchManager::fullTextSearch(const std::string& query, std::size_t k) const {
+    std::vector<Location> matches;
+    if (!locationManager || k == 0) {
+        return matches;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<FullTextIndex::Hit> hits;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncFullText(*snapshot);
+        hits = fullText.search(query, k);
+    }
+    bool lazy = locationManager->lazyDescriptionsEnabled();
+    matches.reserve(hits.size());
+    for (const auto& hit : hits) {
+        LocationView view{};
+        if (!snapshot->viewLocation(hit.id, view)) continue;
+        matches.push_back(view.toLocation());
+        if (lazy) {
+            matches.back().description = locationManager->description(hit.id);
+        }
+    }
+    return matches;
+}
+
+std::size_t SearchManager::findLocations(const LocationQuery& query, std::size_t offset, std::size_t limit,
+                                         const std::function<void(const LocationView&)>& visitor) const {
+    if (!locationManager) {
+        return 0;
+    }
+    auto snapshot = locationManager->snapshot();
+    std::vector<int> nameIds;
+    if (!query.nameContains.empty()) {
+        auto rows = matchingRows(*snapshot, query.nameContains);
+        if (rows->empty()) return 0;
+        nameIds.reserve(rows->size());
+        for (std::size_t row : *rows) {
+            nameIds.push_back(snapshot->idAt(row));
+        }
+    }
+    TypeId typeId = TypeDictionary::kInvalidType;
+    if (!query.type.empty()) {
+        typeId = snapshot->typeDictionary().find(query.type);
+        if (typeId == TypeDictionary::kInvalidType) return 0;
+    }
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        syncFilterIndex(*snapshot);
+        ids = filterIndex.filter(query.type.empty() ? nullptr : &typeId, query.minPopularity, query.maxPopularity,
+                                 query.nameContains.empty() ? nullptr : &nameIds);
+    }
+    auto rows = rowsInOrder(*snapshot, ids);
+    for (std::size_t i = offset; i < rows.size() && i - offset < limit; ++i) {
+        visitor(snapshot->viewAt(rows[i]));
+    }
+    return rows.size();
+}
+
+std::vector<Location> SearchManager::findLocations(const LocationQuery& query) const {
+    std::vector<Location> matches;
+    findLocations(query, 0, SIZE_MAX, [&](const LocationView& view) { matches.push_back(view.toLocation()); });
     return matches;
 }
@@ -0,0 +1,86 @@
+#include "SearchSession.h"
+#include "CaseInsensitiveSearch.h"
+#include "SearchManager.h"
+#include "TextUtils.h"
+
+#include <algorithm>
+
+namespace {
+// 有 n-gram 索引时，大结果集逐条核对反而比重新求倒排表交集慢，只对较小的结果集做增量筛选
+constexpr std::size_t kIndexedRefineLimit = 1024;
+} // namespace
+
+SearchSession::SearchSession(const SearchManager& manager) : searchManager(&manager) {}
+
+std::size_t SearchSession::update(const std::string& keyword) {
+    LocationManager* locations = searchManager->locationManager;
+    if (!locations) {
+        rows.clear();
+        return 0;
+    }
+    auto current = locations->snapshot();
+    std::string lowered = asciiLower(keyword);
+    bool sameData = started && snapshot && snapshot->generation() == current->generation();
+    if (sameData && lowered == lowerKeyword) {
+        return rows.size();
+    }
+    bool narrows = sameData && !lowerKeyword.empty() && lowered.find(lowerKeyword) != std::string::npos;
+    if (narrows && (rows.size() <= kIndexedRefineLimit || !searchManager->nameIndexingEnabled())) {
+        // 包含旧关键字的名称必然在旧结果中，只需在旧结果里再核对一遍
+        rows.erase(std::remove_if(rows.begin(), rows.end(),
+                                  [&](std::size_t row) {
+                                      return !containsIgnoreCase(snapshot->viewAt(row).name, keyword);
+                                  }),
+                   rows.end());
+        ++refinedCount;
+    } else {
+        snapshot = std::move(current);
+        if (keyword.empty()) {
+            rows.resize(snapshot->size());
+            for (std::size_t row = 0; row < rows.size(); ++row) {
+                rows[row] = row;
+            }
+        } else {
+            rows = *searchManager->matchingRows(*snapshot, keyword);
+        }
+        ++fullLookupCount;
+    }
+    lowerKeyword = std::move(lowered);
+    started = true;
+    return rows.size();
+}
+
+void SearchSession::reset() {
+    snapshot.reset();
+    lowerKeyword.clear();
+    rows.clear();
+    started = false;
+}
+
+std::size_t SearchSession::size() const {
+    return rows.size();
+}
+
+std::vector<int> SearchSession::ids() const {
+    std::vector<int> result;
+    result.reserve(rows.size());
+    for (std::size_t row : rows) {
+        result.push_back(snapshot->idAt(row));
+    }
+    return result;
+}
+
+void SearchSession::visit(std::size_t offset, std::size_t limit,
+                          const std::function<void(const LocationView&)>& visitor) const {
+    for (std::size_t i = offset; i < rows.size() && i - offset < limit; ++i) {
+        visitor(snapshot->viewAt(rows[i]));
+    }
+}
+
+std::size_t SearchSession::refinements() const {
+    return refinedCount;
+}
+
+std::size_t SearchSession::fullLookups() const {
+    return fullLookupCount;
+}
@@ -11,6 +11,7 @@
 void ShuttleService::addStation(const std::string& stationName) {
     // 为新站点创建一个空的乘客队列
     stationQueues.emplace(stationName, MyQueue<std::string>());
+    ++generationCounter;
 }
 
 // 乘客加入指定站点的候车队列
@@ -23,6 +24,7 @@ void ShuttleService::joinQueue(const std::string& stationName, const std::string
     }
     // 将乘客加入对应站点的队列末尾
     stationQueues[stationName].push(passengerName);
+    ++generationCounter;
 }
 
 // 指定站点的排队乘客上车（从队列前端取出一名乘客）
@@ -42,6 +44,7 @@ std::string ShuttleService::leaveQueue(const std::string& stationName) {
     it->second.pop();
     // 将乘客加入车上乘客列表
     onboardPassengers.push_back(passenger);
+    ++generationCounter;
     return passenger;
 }
 
@@ -86,6 +89,7 @@ void ShuttleService::dropOffPassenger(const std::string& passengerName) {
     dropoffHistory.push_back(passengerName);
     // 从车上乘客列表中移除该乘客
     onboardPassengers.erase(it);
+    ++generationCounter;
 }
 
 // 获取当前车上乘客列表
@@ -149,4 +153,11 @@ void ShuttleService::loadState(const ShuttlePersistentState& state) {
         // 将重建的队列加入站点管理器
         stationQueues.emplace(kv.first, std::move(q));
     }
+    ++generationCounter;
+}
+
+// 获取当前变更代数
+// 返回值：单调递增的代数，每次修改状态后加一
+std::uint64_t ShuttleService::generation() const {
+    return generationCounter;
 }
@@ -271,9 +271,9 @@ void SmartCampusAssistant::saveSchedule() const {
 
 void SmartCampusAssistant::loadNavigation() {
     navigationGraph.clear();
-    for (const auto& loc : locationManager.getAllLocations()) {
-        navigationGraph.addLocation(loc.name);
-    }
+    locationManager.forEachLocation([this](const LocationView& loc) {
+        navigationGraph.addLocation(std::string(loc.name));
+    });
 
     std::filesystem::path file = std::filesystem::path(dataDir) / kNavigationFile;
     std::ifstream fin(file);
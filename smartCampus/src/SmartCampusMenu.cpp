@@ -1,5 +1,6 @@
 #include "SmartCampusMenu.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <limits>
@@ -48,12 +49,20 @@ std::string readLine(const std::string& prompt) {
 
 std::vector<std::string> collectLocationNames(const LocationManager& manager) {
     std::vector<std::string> names;
-    for (const auto& loc : manager.getAllLocations()) {
-        names.push_back(loc.name);
-    }
+    names.reserve(manager.size());
+    manager.forEachLocation([&names](const LocationView& loc) {
+        names.emplace_back(loc.name);
+    });
     return names;
 }
 
+void recordVisitByName(LocationManager& manager, const SearchManager& search, const std::string& name) {
+    int id = 0;
+    if (search.findIdByName(name, id)) {
+        manager.recordVisit(id);
+    }
+}
+
 void printOptions(const std::vector<std::string>& options, const std::string& header) {
     if (options.empty()) {
         std::cout << "当前列表为空。\n";
@@ -120,20 +129,46 @@ void SmartCampusMenu::handleMainSelection(int choice) {
         break;
     case 5: {
         std::string keyword = readLine("请输入地点名称关键字：");
-        auto results = searchManager.searchByName(keyword);
-        if (results.empty()) {
-            std::cout << "未找到匹配的地点。\n";
-        } else {
-            std::cout << "找到 " << results.size() << " 个地点：\n";
-            for (const auto& loc : results) {
+        const std::size_t pageSize = 20;
+        std::size_t offset = 0;
+        while (true) {
+            std::size_t total = searchManager.searchByName(keyword, offset, pageSize, [](const LocationView& loc) {
                 std::cout << "ID: " << loc.id << " | " << loc.name << " | 类型: " << loc.type
                           << " | 人气: " << loc.popularity << "\n";
+            });
+            if (total == 0) {
+                auto byPinyin = searchManager.searchByPinyin(keyword);
+                if (!byPinyin.empty()) {
+                    std::cout << "按拼音首字母找到 " << byPinyin.size() << " 个地点：\n";
+                    for (const auto& loc : byPinyin) {
+                        std::cout << "ID: " << loc.id << " | " << loc.name << " | 类型: " << loc.type
+                                  << " | 人气: " << loc.popularity << "\n";
+                    }
+                    break;
+                }
+                auto similar = searchManager.fuzzySearch(keyword, 2, 5);
+                if (similar.empty()) {
+                    std::cout << "未找到匹配的地点。\n";
+                } else {
+                    std::cout << "未找到匹配的地点，您是不是要找：\n";
+                    for (const auto& loc : similar) {
+                        std::cout << "ID: " << loc.id << " | " << loc.name << " | 类型: " << loc.type
+                                  << " | 人气: " << loc.popularity << "\n";
+                    }
+                }
+                break;
+            }
+            std::size_t shown = std::min(total, offset + pageSize);
+            std::cout << "共找到 " << total << " 个地点，当前显示第 " << offset + 1 << "-" << shown << " 个。\n";
+            if (shown >= total || readLine("输入 n 查看下一页，其他键返回：") != "n") {
+                break;
             }
+            offset = shown;
         }
         break;
     }
     case 6: {
-        auto ranking = rankingManager.rankByPopularity();
+        auto ranking = rankingManager.rankedViews();
         if (ranking.empty()) {
             std::cout << "暂无地点信息。\n";
         } else {
@@ -410,6 +445,7 @@ void SmartCampusMenu::showNavigationMenu() {
                     std::cout << path[i];
                 }
                 std::cout << "\n";
+                recordVisitByName(locationManager, searchManager, end);
             }
         } else if (choice == 3) {
             return;
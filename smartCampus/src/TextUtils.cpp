@@ -0,0 +1,141 @@
+#include "TextUtils.h"
+
+namespace {
+bool isCjk(char32_t cp) {
+    return (cp >= 0x3040 && cp <= 0x30FF)      // 假名
+           || (cp >= 0x3400 && cp <= 0x4DBF)   // 扩展 A
+           || (cp >= 0x4E00 && cp <= 0x9FFF)   // 基本汉字
+           || (cp >= 0xAC00 && cp <= 0xD7AF)   // 韩文音节
+           || (cp >= 0xF900 && cp <= 0xFAFF)   // 兼容汉字
+           || (cp >= 0x20000 && cp <= 0x3134F); // 扩展 B 及以后
+}
+
+bool isAsciiWordChar(char32_t cp) {
+    return (cp >= '0' && cp <= '9') || (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+}
+
+void flushCjkRun(const std::vector<char32_t>& run, std::vector<std::string>& tokens) {
+    if (run.size() == 1) {
+        tokens.emplace_back();
+        appendUtf8(tokens.back(), run[0]);
+        return;
+    }
+    for (std::size_t i = 0; i + 1 < run.size(); ++i) {
+        tokens.emplace_back();
+        appendUtf8(tokens.back(), run[i]);
+        appendUtf8(tokens.back(), run[i + 1]);
+    }
+}
+} // namespace
+
+std::vector<char32_t> decodeUtf8(std::string_view text) {
+    std::vector<char32_t> codepoints;
+    codepoints.reserve(text.size());
+    std::size_t i = 0;
+    while (i < text.size()) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        std::size_t length = 0;
+        char32_t cp = 0;
+        if (lead < 0x80) {
+            length = 1;
+            cp = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            cp = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            cp = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            cp = lead & 0x07;
+        }
+        bool valid = length > 0 && i + length <= text.size();
+        for (std::size_t k = 1; valid && k < length; ++k) {
+            unsigned char next = static_cast<unsigned char>(text[i + k]);
+            if ((next & 0xC0) != 0x80) {
+                valid = false;
+            } else {
+                cp = (cp << 6) | (next & 0x3F);
+            }
+        }
+        if (!valid) {
+            codepoints.push_back(0x110000 + lead);
+            ++i;
+            continue;
+        }
+        codepoints.push_back(cp);
+        i += length;
+    }
+    return codepoints;
+}
+
+void appendUtf8(std::string& out, char32_t cp) {
+    if (cp >= 0x110000) {
+        out.push_back(static_cast<char>(cp - 0x110000)); // 还原非法字节
+    } else if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+std::size_t completeUtf8Length(std::string_view text) {
+    std::size_t i = text.size();
+    std::size_t continuation = 0;
+    while (i > 0 && continuation < 3 && (static_cast<unsigned char>(text[i - 1]) & 0xC0) == 0x80) {
+        --i;
+        ++continuation;
+    }
+    if (i == 0) return text.size();
+    unsigned char lead = static_cast<unsigned char>(text[i - 1]);
+    std::size_t expected = 0;
+    if ((lead & 0xE0) == 0xC0) {
+        expected = 1;
+    } else if ((lead & 0xF0) == 0xE0) {
+        expected = 2;
+    } else if ((lead & 0xF8) == 0xF0) {
+        expected = 3;
+    }
+    return continuation < expected ? i - 1 : text.size();
+}
+
+std::string asciiLower(std::string_view text) {
+    std::string res(text);
+    for (char& ch : res) {
+        if (ch >= 'A' && ch <= 'Z') {
+            ch = static_cast<char>(ch - 'A' + 'a');
+        }
+    }
+    return res;
+}
+
+void tokenizeText(std::string_view text, std::vector<std::string>& tokens) {
+    std::string word;
+    std::vector<char32_t> run;
+    for (char32_t cp : decodeUtf8(text)) {
+        if (isAsciiWordChar(cp)) {
+            word.push_back(static_cast<char>(cp >= 'A' && cp <= 'Z' ? cp - 'A' + 'a' : cp));
+        } else if (!word.empty()) {
+            tokens.push_back(std::move(word));
+            word.clear();
+        }
+        if (isCjk(cp)) {
+            run.push_back(cp);
+        } else if (!run.empty()) {
+            flushCjkRun(run, tokens);
+            run.clear();
+        }
+    }
+    if (!word.empty()) tokens.push_back(std::move(word));
+    if (!run.empty()) flushCjkRun(run, tokens);
+}
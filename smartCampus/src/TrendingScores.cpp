@@ -0,0 +1,92 @@
+#include "TrendingScores.h"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+double decayRateFor(double halfLifeSeconds) {
+    // 写成取反形式，NaN 也会被拒绝
+    if (!(halfLifeSeconds > 0)) {
+        throw std::invalid_argument("TrendingScores 半衰期必须为正数");
+    }
+    return std::log(2.0) / halfLifeSeconds;
+}
+
+// e^700 接近 double 上限，留足余量后换算基准时刻
+constexpr double kMaxExponent = 200.0;
+constexpr double kNegligibleScore = 1e-9;
+} // namespace
+
+TrendingScores::TrendingScores(double halfLifeSeconds)
+    : decayRate(decayRateFor(halfLifeSeconds)), base(Clock::now()) {}
+
+double TrendingScores::elapsedSeconds(Clock::time_point now) const {
+    return std::chrono::duration<double>(now - base).count();
+}
+
+void TrendingScores::rebase(Clock::time_point now) {
+    double factor = std::exp(-decayRate * elapsedSeconds(now));
+    std::set<std::pair<double, int>, ByScore> rescaled;
+    std::unordered_map<int, double> rescaledById;
+    for (const auto& entry : ordered) {
+        double value = entry.first * factor;
+        if (value < kNegligibleScore) continue; // 已衰减到可以忽略
+        rescaled.emplace(value, entry.second);
+        rescaledById.emplace(entry.second, value);
+    }
+    ordered.swap(rescaled);
+    scaledById.swap(rescaledById);
+    base = now;
+}
+
+void TrendingScores::setHalfLife(double halfLifeSeconds, Clock::time_point now) {
+    double rate = decayRateFor(halfLifeSeconds);
+    rebase(now);
+    decayRate = rate;
+}
+
+void TrendingScores::addActivity(int id, double amount, Clock::time_point now) {
+    if (decayRate * elapsedSeconds(now) > kMaxExponent) {
+        rebase(now);
+    }
+    double scaled = amount * std::exp(decayRate * elapsedSeconds(now));
+    auto it = scaledById.find(id);
+    if (it != scaledById.end()) {
+        ordered.erase({ it->second, id });
+        it->second += scaled;
+        scaled = it->second;
+    } else {
+        scaledById.emplace(id, scaled);
+    }
+    ordered.emplace(scaled, id);
+}
+
+void TrendingScores::erase(int id) {
+    auto it = scaledById.find(id);
+    if (it == scaledById.end()) return;
+    ordered.erase({ it->second, id });
+    scaledById.erase(it);
+}
+
+void TrendingScores::clear() {
+    ordered.clear();
+    scaledById.clear();
+}
+
+std::size_t TrendingScores::size() const {
+    return ordered.size();
+}
+
+double TrendingScores::score(int id, Clock::time_point now) const {
+    auto it = scaledById.find(id);
+    if (it == scaledById.end()) return 0.0;
+    return it->second * std::exp(-decayRate * elapsedSeconds(now));
+}
+
+void TrendingScores::forEachTop(std::size_t k, const std::function<bool(int id, double score)>& visitor,
+                                Clock::time_point now) const {
+    double factor = std::exp(-decayRate * elapsedSeconds(now));
+    for (auto it = ordered.begin(); it != ordered.end() && k > 0; ++it, --k) {
+        if (!visitor(it->second, it->first * factor)) return;
+    }
+}
@@ -0,0 +1,50 @@
+#include "TypeDictionary.h"
+
+#include <stdexcept>
+
+TypeDictionary::TypeDictionary(const TypeDictionary& other) {
+    *this = other;
+}
+
+TypeDictionary& TypeDictionary::operator=(const TypeDictionary& other) {
+    if (this != &other) {
+        // 键是指向 names 的视图，必须按新副本重建
+        clear();
+        for (const auto& type : other.names) {
+            intern(type);
+        }
+    }
+    return *this;
+}
+
+TypeId TypeDictionary::intern(std::string_view type) {
+    auto it = ids.find(type);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    TypeId id = static_cast<TypeId>(names.size());
+    names.emplace_back(type);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+TypeId TypeDictionary::find(std::string_view type) const {
+    auto it = ids.find(type);
+    return it == ids.end() ? kInvalidType : it->second;
+}
+
+const std::string& TypeDictionary::name(TypeId id) const {
+    if (id >= names.size()) {
+        throw std::out_of_range("TypeDictionary::name 编号越界");
+    }
+    return names[id];
+}
+
+std::size_t TypeDictionary::size() const {
+    return names.size();
+}
+
+void TypeDictionary::clear() {
+    ids.clear();
+    names.clear();
+}